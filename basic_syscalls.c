@@ -8,12 +8,37 @@
 #include <frame_manager.h>
 #include <pcb.h>
 #include <pte_manager.h>
+#include <page_fault.h>
+#include <swap.h>
+#include <dedup.h>
+#include <scheduler.h>
+#include <custom_syscalls.h>
+#include <timer_wheel.h>
+#include <profiler.h>
 #include "load_program.h"
 
 // Syscall which uses KCCopy utility to copy the parent pcb
 int KernelFork(){
+    // bring back every page of the parent that was sampled or swapped out, so that all of them can be shared
+    if (RestoreAllPages() == -1) {
+        TracePrintf(1, "KernelFork: failed to restore parent pages\n");
+        return -1;
+    }
+
     // Create child pcb
     pcb_t *child_pcb = NewPCB();
+    if (child_pcb == NULL) {
+        TracePrintf(1, "KernelFork: failed to create child pcb\n");
+        return -1;
+    }
+
+    // the child has the same areas as the parent
+    if (CopyVMAs(&child_pcb->vmas, curr_pcb->vmas) == -1) {
+        TracePrintf(1, "KernelFork: failed to copy parent areas\n");
+        helper_retire_pid(child_pcb->pid);
+        FreePCB(child_pcb);
+        return -1;
+    }
 
     // make child uc a copy of parent uc
     child_pcb->uc = curr_pcb->uc;
@@ -22,67 +47,59 @@ int KernelFork(){
     curr_pcb->uc.regs[0] = child_pcb->pid;
     child_pcb->uc.regs[0] = 0;
 
-    // set child's parent as the parent
-    child_pcb->parent_pid = curr_pcb->pid;
-
-    // set parent's child to to the child
-    PCBAddChild(curr_pcb, child_pcb->pid);
+    // link the child into its parent's children
+    PCBAddChild(curr_pcb, child_pcb);
     
     // set child's brk as the parent's
     child_pcb->brk = curr_pcb->brk;
     child_pcb->orig_brk = curr_pcb->orig_brk;
 
-    // copy parent pt into child
+    // the child starts with its parent's share of the cpu and its place in the stride order
+    child_pcb->sched_tickets = curr_pcb->sched_tickets;
+    child_pcb->sched_pass = curr_pcb->sched_pass;
+    child_pcb->sched_quantum = curr_pcb->sched_quantum;
+
+    // the child runs the same program, so it maps the same shared text
+    // and loads the pages its parent has not touched yet from the same file
+    child_pcb->text_image = curr_pcb->text_image;
+    RetainTextImage(child_pcb->text_image);
+
+    // share parent pages with the child instead of copying them, visiting only the parent's areas
+    // writable pages become copy-on-write in both, so only pages that are later written get copied
     pte_t *parent_pt = curr_pcb->pt_addr;
     pte_t *child_pt = child_pcb->pt_addr;
-    for (int page = 0; page < MAX_PT_LEN; page++) {
-        pte_t parent_pte = parent_pt[page];
-        if (parent_pte.valid == 1) {
-            pte_t *child_pte = CreateUserPTE(parent_pte.prot);
-            if (child_pte == NULL) {
-                TracePrintf(1, "KernelFork: failed create pte for child pcb\n");
+    for (VMA_t *vma = curr_pcb->vmas; vma != NULL; vma = vma->next) {
+        for (int page = vma->start; page < vma->end; page++) {
+            if (parent_pt[page].valid == 1) {
+                if (parent_pt[page].prot == (PROT_READ | PROT_WRITE)) {
+                    parent_pt[page].prot = COW_PROT;
+                }
+                child_pt[page] = parent_pt[page];
+                RetainFrame(parent_pt[page].pfn);
             }
-            child_pt[page] = *child_pte;
-
-            // make red zone valid
-            void *red_zone_addr = (void *) (DOWN_TO_PAGE(curr_pcb->uc.sp) - (PAGESIZE));
-            int red_zone_page = (((int) red_zone_addr) >> PAGESHIFT) - MAX_PT_LEN;
-            int red_zone_frame = AllocateFrame();
-            PopulatePTE(&parent_pt[red_zone_page], PROT_READ | PROT_WRITE, red_zone_frame);
-
-            // Flush the TLB
-            WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-            // copy parent contents into red zone
-            void *parent_addr = (void *) ((page + MAX_PT_LEN) << PAGESHIFT);
-            memcpy(red_zone_addr, parent_addr, PAGESIZE);
-
-            // Flush the TLB
-            WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-            // point child page at red zone frame
-            int child_frame = child_pte->pfn;
-            child_pt[page].pfn = red_zone_frame;
-            parent_pt[red_zone_page].pfn = child_frame;
-
-            // Flush the TLB
-            WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-            // make red zone invalid
-            ClearPTE(&parent_pt[red_zone_page]);
         }
     }
 
+    // Flush the TLB so the parent sees its pages as read only
+    FlushTLB(TLB_FLUSH_1);
+
     if (KernelContextSwitch(KCCopy, child_pcb, NULL) == -1) {
         TracePrintf(1, "KernelFork: failed to copy curr_pcb into child_pcb\n");
+        // drop the child's references to the shared frames, which leaves the parent's pages
+        // copy-on-write with a single reference, so its next write to each just makes it writable again
+        ClearAddressSpace(child_pcb);
+        ReleaseTextImage(child_pcb->text_image);
+        child_pcb->text_image = NULL;
+        PCBRemoveChild(child_pcb);
+        helper_retire_pid(child_pcb->pid);
+        FreePCB(child_pcb);
         // set the return value in parent to be -1
+        curr_pcb->uc.regs[0] = ERROR;
         return -1;
     }
 
-    // Flush the TLB
-    WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-    WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
+    // nothing needs flushing here: KCCopy only touched a kmap page, and the child
+    // first runs through KCSwitch, which flushes what changed for it
     return 0;
 
 }
@@ -108,52 +125,77 @@ int KernelExec(char *filename, char **argvec){
 // syscall for exiting a process and saving exit status for later collection
 void KernelExit(UserContext *uc, int status){
     // if the initial process exits, halt the system
-    int pid = curr_pcb->pid;
-    if (pid == init_pcb->pid) {
+    pcb_t *pcb = curr_pcb;
+    if (pcb == init_pcb) {
         TracePrintf(1,"init_pcb exited, now halting\n");
+        PrintSwapStats();
+        PrintDedupStats();
+        PrintSwitchStats();
+        PrintSchedStats();
+        DumpProfile(pcb);
         Halt();
     }
 
-    // the integer status value is saved for possible later collection by parent
-    SaveExitStatus(curr_pcb->pid, status);
+    // children that are still running are adopted by init, and children that have
+    // already exited can no longer be collected by anyone, so they are freed now
+    while (pcb->children != NULL) {
+        pcb_t *child = pcb->children;
+        PCBRemoveChild(child);
+        PCBAddChild(init_pcb, child);
+    }
+    pcb_t *zombie;
+    while ((zombie = PCBTakeZombie(pcb)) != NULL) {
+        ReapPCB(zombie);
+    }
 
-    // check if any parents were waiting for this child
-    TickChildWaitPCBs(pid, status);
+    // the profile is resolved against the executable, so it is printed while the process still holds it
+    DumpProfile(pcb);
 
     // all resources used by the calling process will be freed,
-    ClearPT(curr_pcb->pt_addr);
-    helper_retire_pid(curr_pcb->pid);
-    free(curr_pcb->pt_addr);
-    free(curr_pcb->child_pids);
-    ClearPTE(&curr_pcb->kernel_stack_pages[0]);
-    ClearPTE(&curr_pcb->kernel_stack_pages[1]);
-    free(curr_pcb);
+    ClearAddressSpace(pcb);
+    ReleaseTextImage(pcb->text_image);
+    pcb->text_image = NULL;
+
+    // the pcb itself stays behind as a zombie holding the status, and is freed once the parent collects it
+    // it is still running on its kernel stack here, so it can't be freed before switching away anyway
+    pcb->exit_status = status;
+    NotifyParent(pcb);
 
     // switch pcbs
-    SwitchPCB(uc, 0, NULL);
+    SwitchPCB(uc, SWITCH_BLOCK, NULL);
 }
 
 // syscall for blocking a process until a child process exits
-int KernelWait(int *status_ptr){
-    // Collect the process ID and exit status returned by a child process of the calling program.
-
-    // If the calling process has no remaining child processess (exited or running), then this call returns immediately with ERROR
-    if (curr_pcb->child_pids_count == 0) {
-        return -1;
-    }
-
-    // If the caller has an exited child whose information has not yet been collected via Wait, then this call will return immediately with that information.
-    for (int i = 0; i < curr_pcb->child_pids_count; i++) {
-        int child_pid = curr_pcb->child_pids[i];
-        int status = GetExitStatus(child_pid);
-        if (status != -1) {
+// each exited child is a zombie on its parent's list, so collecting one takes the same time however many children there are
+int KernelWait(int *status_ptr, UserContext *uc){
+    while (1) {
+        // If the caller has an exited child whose information has not yet been collected via Wait, then this call will return immediately with that information.
+        if (curr_pcb->zombies != NULL) {
+            if (status_ptr != NULL && PrepareUserWrite(status_ptr, sizeof(int)) == -1) {
+                return -1;
+            }
+            pcb_t *zombie = PCBTakeZombie(curr_pcb);
+            int pid = zombie->pid;
             if (status_ptr != NULL) {
-                *status_ptr = status;
+                *status_ptr = zombie->exit_status;
             }
-            return child_pid;
+            // the child's use is handed to the parent before it is freed
+            curr_pcb->waited_rusage = zombie->rusage;
+            AddRusage(&curr_pcb->child_rusage, &zombie->rusage);
+            AddRusage(&curr_pcb->child_rusage, &zombie->child_rusage);
+            ReapPCB(zombie);
+            return pid;
         }
+
+        // If the calling process has no remaining child processess (exited or running), then this call returns immediately with ERROR
+        if (curr_pcb->children == NULL) {
+            return -1;
+        }
+
+        // otherwise block until the next child to exit wakes this process up
+        curr_pcb->waiting_for_child = 1;
+        SwitchPCB(uc, SWITCH_BLOCK, NULL);
     }
-    return 0;
 }
 
 // Returns the process ID of the calling process.
@@ -164,52 +206,43 @@ int KernelGetPid(){
 // sets the operating system’s idea of the lowest location not used by the program (called the “break”) to addr
 // If any error is encountered , the value ERROR is returned.
 int KernelBrk(void *addr){
-    
-    // check if addr is above red zone
-    int red_zone = (int) (curr_pcb->uc.sp) - PAGESIZE;
-    if ( addr > (void *) red_zone)
-    {
-        TracePrintf(1, "KernelBrk: addr %x above red zone %x\n", addr, red_zone);
-        return -1;
-    }
     void *orig_brk = curr_pcb->orig_brk;
     if ( addr < orig_brk)
     {
         TracePrintf(1, "KernelBrk: addr %x below original brk %x\n", addr, orig_brk);
         return -1;
     }
-    // handle case where addr is above the current kernel brk
-    if (addr >= curr_pcb->brk)
+    // the heap area only ends at the page containing the break, and each heap page is mapped when it is first touched
+    VMA_t *heap = FindVMAKind(curr_pcb->vmas, VMA_HEAP);
+    if (heap == NULL)
     {
-        int num_pages = UP_TO_PAGE(addr-curr_pcb->brk) >> PAGESHIFT;
-        int start_page = UP_TO_PAGE(curr_pcb->brk) >> PAGESHIFT;
-        for (int page = start_page; page < start_page+num_pages; page++)
-        {
-            pte_t *pte = CreateUserPTE(PROT_READ | PROT_WRITE);
-            if (pte == NULL)
-            {
-                TracePrintf(1, "KernelBrk: failed to create PTE \n");
-                return -1;
-            }
-            pte_t *pt = curr_pcb->pt_addr;
-            pt[page-MAX_PT_LEN] = *pte;
-        }
-    // handle case where addr is below current kernel brk
-    } else
+        TracePrintf(1, "KernelBrk: process has no heap\n");
+        return -1;
+    }
+    int end_page = REGION_1_PAGE(UP_TO_PAGE(addr));
+    if (end_page < heap->start)
+    {
+        end_page = heap->start;
+    }
+    // check if addr is above red zone, the page left unmapped below the stack as it currently is
+    if (heap->next != NULL && end_page > heap->next->start - 1)
+    {
+        TracePrintf(1, "KernelBrk: addr %x above red zone at page %d\n", addr, heap->next->start - 1);
+        return -1;
+    }
+
+    // shrinking it releases every page that lies entirely above the new break
+    if (end_page < heap->end)
     {
-        int num_pages = DOWN_TO_PAGE(addr-curr_pcb->brk) >> PAGESHIFT;
-        int start_page = (unsigned int)curr_pcb->brk >> PAGESHIFT;
-        for (int page = start_page; page > start_page-num_pages; page--)
+        ForgetPages(curr_pcb, end_page, heap->end);
+        if (ClearPTERegion(curr_pcb->pt_addr, end_page, heap->end) == -1)
         {
-            pte_t *pt = curr_pcb->pt_addr;
-            pte_t pte = pt[page-MAX_PT_LEN];
-            if (FreeUserPTE(&pte) == -1)
-            {
-                TracePrintf(1, "SetKernelBrk: failed to free pte at page %d\n", page);
-                return -1;
-            }
+            TracePrintf(1, "KernelBrk: failed to free pages %d to %d\n", end_page, heap->end);
+            return -1;
         }
+        FlushTLB(TLB_FLUSH_1);
     }
+    heap->end = end_page;
     curr_pcb->brk = addr;
     return 0;
 }
@@ -222,6 +255,125 @@ int KernelDelay(int clock_ticks){
 	if (clock_ticks < 0) {
 		return -1;
     }
-    curr_pcb->delay_ticks += clock_ticks;
+    // the process goes to sleep on the timing wheel once it switches away
+    curr_pcb->wake_tick = clock_ticks_now + clock_ticks;
+    return 0;
+}
+
+// returns the process SetQuantum or SetTickets may change, the caller for pid 0 or its own pid,
+// or one of its children that has not exited, NULL for any other pid
+pcb_t *SchedTarget(int pid) {
+    if (pid == 0 || pid == curr_pcb->pid) {
+        return curr_pcb;
+    }
+    pcb_t *pcb = FindPCB(pid);
+    if (pcb == NULL || pcb->parent != curr_pcb || pcb->zombie) {
+        return NULL;
+    }
+    return pcb;
+}
+
+// syscall for setting how many clock ticks a process runs for before the scheduler may switch away from it
+// a process may only set its own quantum or those of its children
+int KernelSetQuantum(int pid, int ticks){
+    if (ticks < 1 || ticks > MAX_QUANTUM_TICKS) {
+        TracePrintf(1, "KernelSetQuantum: quantum %d out of range\n", ticks);
+        return -1;
+    }
+    pcb_t *pcb = SchedTarget(pid);
+    if (pcb == NULL) {
+        TracePrintf(1, "KernelSetQuantum: pid %d is not a child of pid %d\n", pid, curr_pcb->pid);
+        return -1;
+    }
+    pcb->sched_quantum = ticks;
+    return 0;
+}
+
+// syscall for setting a process's share of the cpu under the stride policy
+// a process may only set its own tickets or those of its children
+int KernelSetTickets(int pid, int tickets){
+    if (tickets < 1 || tickets > MAX_TICKETS) {
+        TracePrintf(1, "KernelSetTickets: %d tickets out of range\n", tickets);
+        return -1;
+    }
+    pcb_t *pcb = SchedTarget(pid);
+    if (pcb == NULL) {
+        TracePrintf(1, "KernelSetTickets: pid %d is not a child of pid %d\n", pid, curr_pcb->pid);
+        return -1;
+    }
+    pcb->sched_tickets = tickets;
+    return 0;
+}
+
+// what a process is doing, as reported by ProcList
+int ProcState(pcb_t *pcb) {
+    if (pcb == curr_pcb) {
+        return PROC_RUNNING;
+    }
+    if (pcb->zombie) {
+        return PROC_ZOMBIE;
+    }
+    if (pcb->sched_ready) {
+        return PROC_READY;
+    }
+    if (pcb->wake_tick > clock_ticks_now) {
+        return PROC_SLEEPING;
+    }
+    return PROC_BLOCKED;
+}
+
+// syscall for copying a snapshot of up to max processes into buf
+// the whole buffer is made writable first, so every process is copied out within this one trap
+int KernelProcList(ProcInfo_t *buf, int max){
+    if (max < 0) {
+        TracePrintf(1, "KernelProcList: max %d is negative\n", max);
+        return -1;
+    }
+    if (buf == NULL) {
+        return num_pcbs;
+    }
+    int count = max < num_pcbs ? max : num_pcbs;
+    if (PrepareUserWrite(buf, count * sizeof(ProcInfo_t)) == -1) {
+        TracePrintf(1, "KernelProcList: buffer %x is not writable\n", buf);
+        return -1;
+    }
+    int i = 0;
+    for (pcb_t *pcb = all_pcbs; pcb != NULL && i < count; pcb = pcb->all_next) {
+        buf[i].pid = pcb->pid;
+        buf[i].ppid = pcb->parent != NULL ? pcb->parent->pid : -1;
+        buf[i].state = ProcState(pcb);
+        buf[i].sched_level = pcb->sched_level;
+        buf[i].quantum = SchedQuantum(pcb);
+        buf[i].tickets = pcb->sched_tickets;
+        i++;
+    }
+    return i;
+}
+
+// syscall for copying what the caller, one of its children, or its collected children used into buf
+int KernelGetRusage(int who, Rusage_t *buf){
+    Rusage_t *rusage;
+    int frames = 0;
+    if (who == RUSAGE_CHILDREN) {
+        rusage = &curr_pcb->child_rusage;
+    } else if (who == RUSAGE_WAITED) {
+        rusage = &curr_pcb->waited_rusage;
+    } else {
+        pcb_t *pcb = curr_pcb;
+        if (who != 0 && who != curr_pcb->pid) {
+            if ((pcb = FindPCB(who)) == NULL || pcb->parent != curr_pcb) {
+                TracePrintf(1, "KernelGetRusage: pid %d is not a child of pid %d\n", who, curr_pcb->pid);
+                return -1;
+            }
+        }
+        rusage = &pcb->rusage;
+        frames = PCBResidentFrames(pcb);
+    }
+    if (PrepareUserWrite(buf, sizeof(Rusage_t)) == -1) {
+        TracePrintf(1, "KernelGetRusage: buffer %x is not writable\n", buf);
+        return -1;
+    }
+    *buf = *rusage;
+    buf->frames = frames;
     return 0;
 }
@@ -7,6 +7,7 @@
 #define _basic_syscalls_h_include
 
 #include <hardware.h>
+#include <custom_syscalls.h>
 
 // Syscall which uses KCCopy utility to copy the parent pcb
 int KernelFork();
@@ -18,7 +19,7 @@ int KernelExec(char *filename, char **argvec);
 void KernelExit(UserContext *uc, int status);
 
 // syscall for blocking a process until a child process exits
-int KernelWait(int *status_ptr);
+int KernelWait(int *status_ptr, UserContext *uc);
 
 // Returns the process ID of the calling process.
 int KernelGetPid();
@@ -30,4 +31,16 @@ int KernelBrk(void *addr);
 // syscall for blocking a process until a the specified number of clock ticks pass
 int KernelDelay(int clock_ticks);
 
+// syscall for setting how many clock ticks a process runs for before the scheduler may switch away from it
+int KernelSetQuantum(int pid, int ticks);
+
+// syscall for setting a process's share of the cpu under the stride policy
+int KernelSetTickets(int pid, int tickets);
+
+// syscall for copying a snapshot of up to max processes into buf
+int KernelProcList(ProcInfo_t *buf, int max);
+
+// syscall for copying what the caller, one of its children, or its collected children used into buf
+int KernelGetRusage(int who, Rusage_t *buf);
+
 #endif
@@ -0,0 +1,79 @@
+// Contains the kernel options that can be set on the yalnix command line
+//
+// Andrew Chen
+// 10/2026
+
+#include <stdlib.h>
+#include <string.h>
+#include <ykernel.h>
+#include <boot_options.h>
+#include <scheduler.h>
+#include <profiler.h>
+#include <zram.h>
+#include <swap.h>
+
+// number of pages below the faulting page mapped each time a stack grows
+int stack_prefault_pages = 4;
+
+// most pages a process's stack may grow to
+int stack_limit_pages = 64;
+
+// an option that takes either a non negative integer value or a string
+struct BootOption {
+  char *key;
+  int *value;             // where an integer value goes, NULL for a string option
+  char **string;          // where a string value goes, NULL for an integer option
+};
+
+typedef struct BootOption BootOption_t;
+
+BootOption_t boot_options[] = {
+  {"stack_prefault", &stack_prefault_pages, NULL},
+  {"stack_limit", &stack_limit_pages, NULL},
+  {"sched", NULL, &sched_policy_name},
+  {"quantum", &default_quantum_ticks, NULL},
+  {"profile", &profile_enabled, NULL},
+  {"profile_depth", &profile_depth, NULL},
+  {"zram_pages", &zram_arena_pages, NULL},
+  {"swap_file", NULL, &swap_file_name},
+  {NULL, NULL, NULL}
+};
+
+// sets the option named by the "key=value" argument arg
+// returns -1 if there is no such option or an integer option's value is not a non negative integer
+int SetBootOption(char *arg) {
+  char *eq = strchr(arg, '=');
+  for (BootOption_t *option = boot_options; option->key != NULL; option++) {
+    if (strlen(option->key) != eq - arg || strncmp(option->key, arg, eq - arg) != 0) {
+      continue;
+    }
+    // the command line stays around for as long as the kernel runs, so a string value can point into it
+    if (option->string != NULL) {
+      *option->string = eq + 1;
+      TracePrintf(1, "SetBootOption: %s = %s\n", option->key, *option->string);
+      return 0;
+    }
+    char *end;
+    long value = strtol(eq + 1, &end, 10);
+    if (end == eq + 1 || *end != '\0' || value < 0) {
+      TracePrintf(0, "SetBootOption: bad value in '%s'\n", arg);
+      return -1;
+    }
+    *option->value = (int) value;
+    TracePrintf(1, "SetBootOption: %s = %d\n", option->key, *option->value);
+    return 0;
+  }
+  TracePrintf(0, "SetBootOption: unknown option '%s'\n", arg);
+  return -1;
+}
+
+// reads every leading "key=value" argument on the command line into the matching option
+// returns the index of the first argument that is not an option, which names the init program
+int ParseBootOptions(char *cmd_args[]) {
+  int i = 0;
+  while (cmd_args[i] != NULL && strchr(cmd_args[i], '=') != NULL) {
+    SetBootOption(cmd_args[i]);
+    i++;
+  }
+  return i;
+}
@@ -0,0 +1,35 @@
+// Contains the kernel options that can be set on the yalnix command line
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _boot_options_h
+#define _boot_options_h
+
+// number of pages below the faulting page mapped each time a stack grows
+extern int stack_prefault_pages;
+
+// most pages a process's stack may grow to
+extern int stack_limit_pages;
+
+// clock ticks a process runs before the scheduler may switch away from it, unless it sets its own with SetQuantum
+extern int default_quantum_ticks;
+
+// name of the scheduling policy to use, see scheduler.h
+extern char *sched_policy_name;
+
+// 1 to profile every process, and caller frames to walk for each sample, see profiler.h
+extern int profile_enabled;
+extern int profile_depth;
+
+// pages of kernel heap set aside at boot for compressed pages, see zram.h
+extern int zram_arena_pages;
+
+// path of the host file to swap to, see swap.h
+extern char *swap_file_name;
+
+// reads every leading "key=value" argument on the command line into the matching option
+// returns the index of the first argument that is not an option, which names the init program
+int ParseBootOptions(char *cmd_args[]);
+
+#endif
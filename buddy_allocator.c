@@ -0,0 +1,145 @@
+// Contains a power-of-two buddy allocator for runs of physically contiguous frames
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <buddy_allocator.h>
+
+// a free block of 2^order frames always starts at a frame that is a multiple of 2^order
+// its buddy is the block of the same order that it would merge with
+#define BUDDY_OF(frame, order) ((frame) ^ (1 << (order)))
+
+// first frame of each order's doubly linked free list, -1 when the list is empty
+int buddy_free_lists[MAX_BUDDY_ORDER + 1];
+
+// free list links, indexed by the first frame of a free block
+int *buddy_next;
+int *buddy_prev;
+
+// "buddy_block_order[frame] == order" means a free block of that order starts at frame
+// -1 for every frame that does not start a free block
+signed char *buddy_block_order;
+
+// number of frames managed by the buddy allocator
+int buddy_num_frames;
+
+// add a free block to the front of the free list for its order
+void BuddyPush(int frame, int order) {
+  buddy_block_order[frame] = order;
+  buddy_prev[frame] = -1;
+  buddy_next[frame] = buddy_free_lists[order];
+  if (buddy_free_lists[order] != -1) {
+    buddy_prev[buddy_free_lists[order]] = frame;
+  }
+  buddy_free_lists[order] = frame;
+}
+
+// unlink a free block from the free list for its order
+void BuddyUnlink(int frame, int order) {
+  if (buddy_prev[frame] != -1) {
+    buddy_next[buddy_prev[frame]] = buddy_next[frame];
+  } else {
+    buddy_free_lists[order] = buddy_next[frame];
+  }
+  if (buddy_next[frame] != -1) {
+    buddy_prev[buddy_next[frame]] = buddy_prev[frame];
+  }
+  buddy_block_order[frame] = -1;
+}
+
+// sets up empty free lists for frames [0, num_frames)
+int InitializeBuddy(int num_frames) {
+  buddy_num_frames = num_frames;
+  buddy_next = malloc(num_frames * sizeof(int));
+  buddy_prev = malloc(num_frames * sizeof(int));
+  buddy_block_order = malloc(num_frames * sizeof(signed char));
+  if (buddy_next == NULL || buddy_prev == NULL || buddy_block_order == NULL) {
+    TracePrintf(1, "InitializeBuddy: failed to malloc free list links\n");
+    return -1;
+  }
+  memset(buddy_block_order, -1, num_frames * sizeof(signed char));
+  for (int order = 0; order <= MAX_BUDDY_ORDER; order++) {
+    buddy_free_lists[order] = -1;
+  }
+  return 0;
+}
+
+// removes a free block of 2^order frames from the free lists and returns its first frame
+// returns -1 if no block of at least that order is free
+int BuddyAllocate(int order) {
+  if (order < 0 || order > MAX_BUDDY_ORDER) {
+    TracePrintf(1, "BuddyAllocate: invalid order %d\n", order);
+    return -1;
+  }
+
+  // find the smallest free block that is large enough
+  int block_order = order;
+  while (block_order <= MAX_BUDDY_ORDER && buddy_free_lists[block_order] == -1) {
+    block_order++;
+  }
+  if (block_order > MAX_BUDDY_ORDER) {
+    return -1;
+  }
+  int frame = buddy_free_lists[block_order];
+  BuddyUnlink(frame, block_order);
+
+  // split it, returning the upper halves to the free lists
+  while (block_order > order) {
+    block_order--;
+    BuddyPush(frame + (1 << block_order), block_order);
+  }
+  return frame;
+}
+
+// removes a single free frame from whichever free block contains it
+// returns -1 if the frame is not free
+int BuddyRemove(int frame) {
+  if (frame < 0 || frame >= buddy_num_frames) {
+    return -1;
+  }
+
+  // find the free block containing the frame
+  int order = 0;
+  int block = frame;
+  while (order <= MAX_BUDDY_ORDER) {
+    block = frame & ~((1 << order) - 1);
+    if (buddy_block_order[block] == order) {
+      break;
+    }
+    order++;
+  }
+  if (order > MAX_BUDDY_ORDER) {
+    return -1;
+  }
+  BuddyUnlink(block, order);
+
+  // split it, returning every half that does not contain the frame
+  while (order > 0) {
+    order--;
+    int half = 1 << order;
+    if (frame < block + half) {
+      BuddyPush(block + half, order);
+    } else {
+      BuddyPush(block, order);
+      block += half;
+    }
+  }
+  return 0;
+}
+
+// returns a block of 2^order frames starting at frame to the free lists, merging it with its free buddies
+void BuddyFree(int frame, int order) {
+  while (order < MAX_BUDDY_ORDER) {
+    int buddy = BUDDY_OF(frame, order);
+    if (buddy >= buddy_num_frames || buddy_block_order[buddy] != order) {
+      break;
+    }
+    BuddyUnlink(buddy, order);
+    if (buddy < frame) {
+      frame = buddy;
+    }
+    order++;
+  }
+  BuddyPush(frame, order);
+}
@@ -0,0 +1,26 @@
+// Contains a power-of-two buddy allocator for runs of physically contiguous frames
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _buddy_allocator_h
+#define _buddy_allocator_h
+
+// largest block handed out by the buddy allocator is 2^MAX_BUDDY_ORDER frames
+#define MAX_BUDDY_ORDER 10
+
+// sets up empty free lists for frames [0, num_frames)
+int InitializeBuddy(int num_frames);
+
+// removes a free block of 2^order frames from the free lists and returns its first frame
+// returns -1 if no block of at least that order is free
+int BuddyAllocate(int order);
+
+// removes a single free frame from whichever free block contains it
+// returns -1 if the frame is not free
+int BuddyRemove(int frame);
+
+// returns a block of 2^order frames starting at frame to the free lists, merging it with its free buddies
+void BuddyFree(int frame, int order);
+
+#endif
@@ -0,0 +1,79 @@
+// Contains the syscalls this kernel adds through the custom syscall numbers,
+// shared by the kernel and by user programs, which include it after yuser.h
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _custom_syscalls_h
+#define _custom_syscalls_h
+
+// SetQuantum(pid, ticks) sets how many clock ticks a process runs for before the scheduler may switch away from it
+// pid 0 means the calling process, and otherwise must be the caller or one of its children
+// returns 0, or ERROR if there is no such process or ticks is not between 1 and MAX_QUANTUM_TICKS
+#define YALNIX_SET_QUANTUM YALNIX_CUSTOM_0
+#define MAX_QUANTUM_TICKS 100
+#define SetQuantum(pid, ticks) Custom0((pid), (ticks), 0, 0)
+
+// SetTickets(pid, tickets) sets a process's share of the cpu under the stride policy, inherited on Fork
+// it accepts the same pids as SetQuantum
+// returns 0, or ERROR if there is no such process or tickets is not between 1 and MAX_TICKETS
+#define YALNIX_SET_TICKETS YALNIX_CUSTOM_1
+#define MAX_TICKETS 1000
+#define SetTickets(pid, tickets) Custom1((pid), (tickets), 0, 0)
+
+// the framework has only three custom syscall numbers, so ProcList and GetRusage share the last one,
+// and name the call they make in their first argument, which is never taken from another argument
+#define YALNIX_PROC_INFO YALNIX_CUSTOM_2
+#define PROC_INFO_LIST 1
+#define PROC_INFO_RUSAGE 2
+
+// what a process is doing when ProcList looks at it
+#define PROC_RUNNING 0        // it is the process on the cpu
+#define PROC_READY 1          // it is waiting for the scheduler to run it
+#define PROC_SLEEPING 2       // it is in Delay
+#define PROC_BLOCKED 3        // it is waiting for a child, a terminal, a pipe, a lock or a cvar
+#define PROC_ZOMBIE 4         // it has exited and its parent has not collected it with Wait yet
+
+// a snapshot of one process, as copied out by ProcList
+struct ProcInfo {
+  int pid;
+  int ppid;                   // pid of the parent, -1 for init and the idle process
+  int state;                  // one of the PROC_ values
+  int sched_level;            // level of the multilevel feedback queue it is at
+  int quantum;                // clock ticks it runs for before the scheduler may switch away from it
+  int tickets;                // share of the cpu under the stride policy
+};
+
+typedef struct ProcInfo ProcInfo_t;
+
+// ProcList(buf, max) copies a snapshot of up to max processes, in no particular order, into buf
+// returns the number copied, or ERROR if buf can't be written or max is negative
+// with a NULL buf nothing is copied and the number of processes is returned, so that buf can be sized
+#define ProcList(buf, max) Custom2(PROC_INFO_LIST, (int) (buf), (max), 0)
+
+// syscall numbers below this are counted one by one in a Rusage, the rest only in the total
+#define RUSAGE_SYSCALLS 128
+
+// what a process has used, as copied out by GetRusage
+struct Rusage {
+  int ticks;                  // clock ticks it was running on
+  int voluntary_switches;     // times it gave up the cpu by blocking, sleeping or exiting
+  int involuntary_switches;   // times it was switched away from while it could still run
+  int page_faults;            // memory traps it took, whether or not they were resolved
+  int frames;                 // frames mapped in its region 1 right now, shared ones included
+  int syscalls;               // syscalls it made
+  int syscalls_by_number[RUSAGE_SYSCALLS]; // syscalls it made, indexed by YALNIX_ syscall number
+};
+
+typedef struct Rusage Rusage_t;
+
+// GetRusage(who, buf) copies what a process has used into buf
+// who is 0 for the calling process, the pid of the caller or one of its children, RUSAGE_CHILDREN
+// for the sum over every child collected with Wait and their own collected children, or RUSAGE_WAITED
+// for the child collected by the last Wait, whose frames are always 0
+// returns 0, or ERROR if there is no such process or buf can't be written
+#define RUSAGE_CHILDREN (-1)
+#define RUSAGE_WAITED (-2)
+#define GetRusage(who, buf) Custom2(PROC_INFO_RUSAGE, (who), (int) (buf), 0)
+
+#endif
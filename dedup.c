@@ -0,0 +1,197 @@
+// Contains the scanner that merges byte-identical user pages into one shared frame
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <kernel.h>
+#include <frame_manager.h>
+#include <pte_manager.h>
+#include <page_fault.h>
+#include <swap.h>
+#include <dedup.h>
+
+// pages scanned so far, indexed by hash modulo DEDUP_TABLE_SIZE
+// a newer page replaces whatever was in its bucket unless the two are merged
+DedupEntry_t dedup_table[DEDUP_TABLE_SIZE];
+
+// page the scanner looks at next, swept across the data, heap and stack areas of every pcb in all_pcbs
+pcb_t *dedup_pcb = NULL;
+int dedup_page = 0;
+
+// number of pages hashed, pages merged into another process's frame or the zero frame,
+// and merged pages given their own copy again by a write
+int num_dedup_scans = 0;
+int num_dedup_merges = 0;
+int num_dedup_zero_merges = 0;
+int num_dedup_unmerges = 0;
+
+// hashes a page with FNV-1a over its words, setting *is_zero if every word is zero
+unsigned int DedupHash(void *addr, int *is_zero) {
+  unsigned int *words = addr;
+  unsigned int hash = 2166136261u;
+  unsigned int any = 0;
+  for (int i = 0; i < PAGESIZE / sizeof(unsigned int); i++) {
+    hash = (hash ^ words[i]) * 16777619u;
+    any |= words[i];
+  }
+  *is_zero = (any == 0);
+  return hash;
+}
+
+// returns 1 if a page may be merged: resident, writable data mapped by no other page table
+// a merged page is marked copy-on-write, which a write fault would undo, so the page's area must be writable
+int IsMergeable(pcb_t *pcb, int page) {
+  pte_t *pte = &((pte_t *) pcb->pt_addr)[page];
+  if (pte->valid == 0 || pcb->page_state[page] != PAGE_RESIDENT || (pte->prot & PROT_EXEC) != 0 ||
+      pte->pfn == zero_frame || FrameRefCount(pte->pfn) != 1) {
+    return 0;
+  }
+  VMA_t *vma = FindVMA(pcb->vmas, page);
+  return vma != NULL && (vma->prot & PROT_WRITE) != 0;
+}
+
+// returns 1 if a table entry still describes a page mapping the same frame
+// the frame may already be shared with pages merged into it earlier
+int IsEntryMapped(DedupEntry_t *entry) {
+  if (entry->pcb == NULL) {
+    return 0;
+  }
+  pte_t *pte = &((pte_t *) entry->pcb->pt_addr)[entry->page];
+  return pte->valid == 1 && entry->pcb->page_state[entry->page] == PAGE_RESIDENT &&
+         pte->pfn == entry->pfn && (pte->prot & PROT_EXEC) == 0 &&
+         (FrameRefCount(entry->pfn) == 1 || IsFrameMerged(entry->pfn));
+}
+
+// makes a page of a pcb a copy-on-write mapping of a frame, dropping the frame it had
+void MergePage(pcb_t *pcb, int page, int frame) {
+  pte_t *pte = &((pte_t *) pcb->pt_addr)[page];
+  if (pte->pfn != frame) {
+    RetainFrame(frame);
+    ReleaseFrame(pte->pfn);
+    pte->pfn = frame;
+  }
+  pte->prot = COW_PROT;
+  if (pcb == curr_pcb) {
+    FlushTLB((unsigned int) REGION_1_PAGE_ADDR(page));
+  }
+}
+
+// hashes one page and merges it with an identical page already in the table, or with the zero frame
+void ScanPage(pcb_t *pcb, int page) {
+  pte_t *pte = &((pte_t *) pcb->pt_addr)[page];
+  void *addr = KMap(pte->pfn);
+  if (addr == NULL) {
+    return;
+  }
+  int is_zero;
+  unsigned int hash = DedupHash(addr, &is_zero);
+  num_dedup_scans++;
+
+  if (is_zero) {
+    KUnmap(addr);
+    MergePage(pcb, page, zero_frame);
+    num_dedup_zero_merges++;
+    return;
+  }
+
+  DedupEntry_t *entry = &dedup_table[hash % DEDUP_TABLE_SIZE];
+  if (entry->hash == hash && IsEntryMapped(entry) && entry->pfn != pte->pfn) {
+    // equal hashes are only a hint, so compare the bytes before sharing anything
+    void *other = KMap(entry->pfn);
+    int same = other != NULL && memcmp(addr, other, PAGESIZE) == 0;
+    if (other != NULL) {
+      KUnmap(other);
+    }
+    KUnmap(addr);
+    if (same) {
+      MergePage(entry->pcb, entry->page, entry->pfn);
+      MergePage(pcb, page, entry->pfn);
+      MarkFrameMerged(entry->pfn);
+      num_dedup_merges++;
+    }
+    return;
+  }
+  KUnmap(addr);
+
+  entry->hash = hash;
+  entry->pcb = pcb;
+  entry->page = page;
+  entry->pfn = pte->pfn;
+}
+
+// returns the first page at or after page inside an area of a pcb the scanner looks at, -1 if there is none
+// text is never merged, and the gap between the heap and the stack has no pages at all
+int NextScanPage(pcb_t *pcb, int page) {
+  for (VMA_t *vma = pcb->vmas; vma != NULL; vma = vma->next) {
+    if (vma->kind == VMA_TEXT || vma->end <= page) {
+      continue;
+    }
+    return page > vma->start ? page : vma->start;
+  }
+  return -1;
+}
+
+// hashes up to count resident private pages, continuing where the last scan stopped,
+// and merges each one with a previously scanned page holding the same bytes
+void ScanForDuplicates(int count) {
+  if (zero_frame == -1) {
+    return;
+  }
+  // only candidate pages count toward the budget, but never go round all the pcbs more than once
+  int wraps = 0;
+  while (count > 0) {
+    if (dedup_pcb == NULL) {
+      if (wraps == 1 || all_pcbs == NULL) {
+        return;
+      }
+      wraps++;
+      dedup_pcb = all_pcbs;
+      dedup_page = 0;
+    }
+    pcb_t *pcb = dedup_pcb;
+    int page = NextScanPage(pcb, dedup_page);
+    if (page == -1) {
+      dedup_pcb = dedup_pcb->all_next;
+      dedup_page = 0;
+      continue;
+    }
+    dedup_page = page + 1;
+    if (IsMergeable(pcb, page)) {
+      ScanPage(pcb, page);
+      count--;
+    }
+  }
+}
+
+// drops every table entry pointing into a pcb, before its address space is replaced or freed
+void DedupRemovePCB(pcb_t *pcb) {
+  for (int i = 0; i < DEDUP_TABLE_SIZE; i++) {
+    if (dedup_table[i].pcb == pcb) {
+      dedup_table[i].pcb = NULL;
+    }
+  }
+  if (dedup_pcb == pcb) {
+    dedup_pcb = pcb->all_next;
+    dedup_page = 0;
+  }
+}
+
+// prints how many pages were scanned and merged, how many merges were undone by writes, and how many frames are saved
+void PrintDedupStats() {
+  // every reference to a merged frame beyond the first is a frame that would otherwise be in use
+  int frames_saved = 0;
+  for (int frame = 0; frame < num_frames; frame++) {
+    if (IsFrameMerged(frame) && FrameRefCount(frame) > 1) {
+      frames_saved += FrameRefCount(frame) - 1;
+    }
+  }
+  TracePrintf(0, "dedup: %d pages scanned, %d merged, %d merged into the zero frame, %d unmerged by writes\n",
+              num_dedup_scans, num_dedup_merges, num_dedup_zero_merges, num_dedup_unmerges);
+  if (num_dedup_scans > 0) {
+    TracePrintf(0, "dedup: %d merges and %d unmerges per 1000 pages scanned\n",
+                (num_dedup_merges + num_dedup_zero_merges) * 1000 / num_dedup_scans,
+                num_dedup_unmerges * 1000 / num_dedup_scans);
+  }
+  TracePrintf(0, "dedup: %d frames saved by merged pages still shared\n", frames_saved);
+}
@@ -0,0 +1,42 @@
+// Contains the scanner that merges byte-identical user pages into one shared frame
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _dedup_h
+#define _dedup_h
+
+#include <ykernel.h>
+#include <pcb.h>
+
+// number of buckets in the table of page hashes
+#define DEDUP_TABLE_SIZE 1024
+
+// number of pages scanned every DEDUP_BUSY_INTERVAL clock ticks while a process runs, and on each tick spent idle
+#define DEDUP_SCAN_PAGES 8
+#define DEDUP_BUSY_INTERVAL 8
+#define DEDUP_IDLE_SCAN_PAGES 64
+
+// page recently scanned by the deduplication scanner, the candidate later pages with the same hash merge into
+struct DedupEntry {
+  unsigned int hash;        // hash of the page contents when it was scanned
+  pcb_t *pcb;               // process the page was found in, NULL if the bucket is empty
+  int page;                 // region 1 page the frame was mapped at
+  int pfn;                  // frame holding the page
+};
+
+typedef struct DedupEntry DedupEntry_t;
+
+extern int num_dedup_unmerges;
+
+// hashes up to count resident private pages, continuing where the last scan stopped,
+// and merges each one with a previously scanned page holding the same bytes
+void ScanForDuplicates(int count);
+
+// drops every table entry pointing into a pcb, before its address space is replaced or freed
+void DedupRemovePCB(pcb_t *pcb);
+
+// prints how many pages were scanned and merged, how many merges were undone by writes, and how many frames are saved
+void PrintDedupStats();
+
+#endif
@@ -4,10 +4,34 @@
 // 2/2024
 
 #include <ykernel.h>
+#include <buddy_allocator.h>
+#include <frame_manager.h>
+#include <pte_manager.h>
+#include <swap.h>
 
-// bit vector which tracks allocated frames
-// "allocated_frames[frame] == 1" means that the frame is allocated
-int *allocated_frames;
+// number of frames tracked by each word of allocated_frames
+#define FRAMES_PER_WORD 32
+
+// word of allocated_frames containing the bit for a frame
+#define FRAME_WORD(frame) ((frame) / FRAMES_PER_WORD)
+
+// mask selecting the bit for a frame within its word
+#define FRAME_BIT(frame) (1u << ((frame) % FRAMES_PER_WORD))
+
+// bit vector which tracks allocated frames, packed 32 frames per word
+// "allocated_frames[FRAME_WORD(frame)] & FRAME_BIT(frame)" means that the frame is allocated
+unsigned int *allocated_frames;
+
+// number of words in allocated_frames
+int num_frame_words;
+
+// number of page table entries referencing each frame
+// a frame is freed when its last reference is released
+int *frame_refcounts;
+
+// "frame_merged[frame] == 1" means the frame was shared by merging identical pages, see dedup.c
+// cleared whenever the frame is allocated again
+unsigned char *frame_merged;
 
 // number of frames in allocated_frames
 int num_frames;
@@ -18,15 +42,46 @@ int num_allocated_frames;
 // the lowest frame above PMEM_BASE
 int min_frame = UP_TO_PAGE(PMEM_BASE)/PAGESIZE;
 
+// frames known to contain only zeros, set aside by RefillZeroedFrames
+// each is already marked allocated with one reference, held by this list until it is handed out
+int zeroed_frames[ZEROED_FRAME_TARGET];
+
+// number of frames in zeroed_frames
+int num_zeroed_frames = 0;
+
 // initializes bit vector to track allocated frames
 int InitializeFrames(int pmem_size) {
   num_frames = (pmem_size / PAGESIZE);
-  allocated_frames = malloc(num_frames * sizeof(int));
+  num_frame_words = (num_frames + FRAMES_PER_WORD - 1) / FRAMES_PER_WORD;
+  allocated_frames = malloc(num_frame_words * sizeof(unsigned int));
   if (allocated_frames == NULL) {
     TracePrintf(1, "InitializeFrames: failed to malloc allocated_frames\n");
     return -1;
   }
-  bzero(allocated_frames, (pmem_size / PAGESIZE) * sizeof(int));
+  bzero(allocated_frames, num_frame_words * sizeof(unsigned int));
+
+  frame_refcounts = malloc(num_frames * sizeof(int));
+  if (frame_refcounts == NULL) {
+    TracePrintf(1, "InitializeFrames: failed to malloc frame_refcounts\n");
+    return -1;
+  }
+  bzero(frame_refcounts, num_frames * sizeof(int));
+
+  frame_merged = malloc(num_frames * sizeof(unsigned char));
+  if (frame_merged == NULL) {
+    TracePrintf(1, "InitializeFrames: failed to malloc frame_merged\n");
+    return -1;
+  }
+  bzero(frame_merged, num_frames * sizeof(unsigned char));
+
+  // hand every frame at or above min_frame to the buddy allocator
+  if (InitializeBuddy(num_frames) == -1) {
+    TracePrintf(1, "InitializeFrames: failed to initialize buddy allocator\n");
+    return -1;
+  }
+  for (int frame = min_frame; frame < num_frames; frame++) {
+    BuddyFree(frame, 0);
+  }
   return 0;
 }
 
@@ -40,27 +95,124 @@ int AllocateSpecificFrame(int frame) {
     TracePrintf(1, "AllocateSpecificFrame: Failed to allocate frame %d: above maximum frame %d\n", frame, num_frames-1);
     return -1;
   }
-  if (allocated_frames[frame] == 1) {
+  if (allocated_frames[FRAME_WORD(frame)] & FRAME_BIT(frame)) {
     TracePrintf(1, "AllocateSpecificFrame: Failed to allocate frame %d: frame is already allocated\n", frame);
     return -1;
   }
+  if (BuddyRemove(frame) == -1) {
+    TracePrintf(1, "AllocateSpecificFrame: Failed to allocate frame %d: frame is not in a free block\n", frame);
+    return -1;
+  }
   num_allocated_frames++;
-  allocated_frames[frame] = 1;
+  allocated_frames[FRAME_WORD(frame)] |= FRAME_BIT(frame);
+  frame_refcounts[frame] = 1;
+  frame_merged[frame] = 0;
   return 0;
 }
 
+// marks a run of 2^order frames just taken from the buddy allocator as allocated with one reference each
+void MarkFramesAllocated(int first_frame, int order) {
+  for (int frame = first_frame; frame < first_frame + (1 << order); frame++) {
+    allocated_frames[FRAME_WORD(frame)] |= FRAME_BIT(frame);
+    frame_refcounts[frame] = 1;
+    frame_merged[frame] = 0;
+  }
+  num_allocated_frames += 1 << order;
+}
+
+// returns every frame set aside by RefillZeroedFrames to the buddy allocator
+void DrainZeroedFrames() {
+  while (num_zeroed_frames > 0) {
+    num_zeroed_frames--;
+    DeallocateFrame(zeroed_frames[num_zeroed_frames]);
+  }
+}
+
+// allocates a run of 2^order physically contiguous frames and returns the first one
+int AllocateFrames(int order) {
+  if (order == 0) {
+    return AllocateFrame();
+  }
+  int first_frame = BuddyAllocate(order);
+  if (first_frame == -1 && num_zeroed_frames > 0) {
+    // zeroed frames may be splitting up the only large enough free block
+    DrainZeroedFrames();
+    first_frame = BuddyAllocate(order);
+  }
+  if (first_frame == -1) {
+    TracePrintf(1, "AllocateFrames: Failed to allocate %d contiguous frames\n", 1 << order);
+    return -1;
+  }
+  MarkFramesAllocated(first_frame, order);
+  return first_frame;
+}
+
 // allocates a previously unallocated frame and returns it
 int AllocateFrame() {
-  // do not allocate frames that are below PMEM_BASE 
-  for (int frame = min_frame; frame < num_frames; frame++ ) {
-    if (allocated_frames[frame] == 0) {
-      allocated_frames[frame] = 1;
-      num_allocated_frames++;
-      return frame;
+  int frame = BuddyAllocate(0);
+  // once nothing else is free, a zeroed frame is as good as any other
+  if (frame == -1 && num_zeroed_frames > 0) {
+    num_zeroed_frames--;
+    return zeroed_frames[num_zeroed_frames];
+  }
+  // otherwise make room by evicting a cold user page to swap
+  if (frame == -1 && ReclaimFrame() == 0) {
+    frame = BuddyAllocate(0);
+  }
+  if (frame == -1) {
+    TracePrintf(1, "AllocateFrame: Failed to allocate frame\n");
+    return -1;
+  }
+  MarkFramesAllocated(frame, 0);
+  return frame;
+}
+
+// fills an allocated frame that is not mapped anywhere with zeros
+int ZeroFrame(int frame) {
+  void *addr = KMap(frame);
+  if (addr == NULL) {
+    TracePrintf(1, "ZeroFrame: failed to map frame %d\n", frame);
+    return -1;
+  }
+  bzero(addr, PAGESIZE);
+  KUnmap(addr);
+  return 0;
+}
+
+// allocates a frame that contains only zeros and returns it
+// a frame zeroed ahead of time is used if there is one, otherwise a new frame is zeroed now
+int AllocateZeroedFrame() {
+  if (num_zeroed_frames > 0) {
+    num_zeroed_frames--;
+    return zeroed_frames[num_zeroed_frames];
+  }
+  int frame = AllocateFrame();
+  if (frame == -1) {
+    return -1;
+  }
+  if (ZeroFrame(frame) == -1) {
+    DeallocateFrame(frame);
+    return -1;
+  }
+  return frame;
+}
+
+// zeroes up to count free frames and sets them aside for AllocateZeroedFrame
+// stops early once ZEROED_FRAME_TARGET frames are ready or no frame is free
+void RefillZeroedFrames(int count) {
+  for (int i = 0; i < count && num_zeroed_frames < ZEROED_FRAME_TARGET; i++) {
+    int frame = BuddyAllocate(0);
+    if (frame == -1) {
+      return;
     }
+    MarkFramesAllocated(frame, 0);
+    if (ZeroFrame(frame) == -1) {
+      DeallocateFrame(frame);
+      return;
+    }
+    zeroed_frames[num_zeroed_frames] = frame;
+    num_zeroed_frames++;
   }
-  TracePrintf(1, "AllocateFrame: Failed to allocate a frame\n");
-  return -1;
 }
 
 // deallocates a previously allocated frame
@@ -73,12 +225,83 @@ int DeallocateFrame(int frame) {
     TracePrintf(1, "DeallocateFrame: Failed to deallocate frame %d: above maximum frame %d\n", frame, num_frames-1);
     return -1;
   }
-  if (allocated_frames[frame] == 0) {
+  if ((allocated_frames[FRAME_WORD(frame)] & FRAME_BIT(frame)) == 0) {
     TracePrintf(1, "DeallocateFrame: Failed to deallocate frame %d: frame is already deallocated\n", frame);
     return -1;
   }
-  allocated_frames[frame] = 0;
+  allocated_frames[FRAME_WORD(frame)] &= ~FRAME_BIT(frame);
+  frame_refcounts[frame] = 0;
+  BuddyFree(frame, 0);
 
   num_allocated_frames--;
   return 0;
 }
+
+// deallocates a run of 2^order frames previously returned by AllocateFrames
+int DeallocateFrames(int first_frame, int order) {
+  for (int frame = first_frame; frame < first_frame + (1 << order); frame++) {
+    if (frame < min_frame || frame >= num_frames || (allocated_frames[FRAME_WORD(frame)] & FRAME_BIT(frame)) == 0) {
+      TracePrintf(1, "DeallocateFrames: Failed to deallocate frame %d: frame is not allocated\n", frame);
+      return -1;
+    }
+  }
+  for (int frame = first_frame; frame < first_frame + (1 << order); frame++) {
+    allocated_frames[FRAME_WORD(frame)] &= ~FRAME_BIT(frame);
+    frame_refcounts[frame] = 0;
+  }
+  BuddyFree(first_frame, order);
+
+  num_allocated_frames -= 1 << order;
+  return 0;
+}
+
+// adds a reference to an allocated frame that is being mapped by another page table entry
+int RetainFrame(int frame) {
+  if (frame < min_frame || frame >= num_frames || frame_refcounts[frame] == 0) {
+    TracePrintf(1, "RetainFrame: Failed to retain frame %d: frame is not allocated\n", frame);
+    return -1;
+  }
+  frame_refcounts[frame]++;
+  return 0;
+}
+
+// drops a reference to an allocated frame, deallocating it when no references remain
+int ReleaseFrame(int frame) {
+  if (frame < min_frame || frame >= num_frames || frame_refcounts[frame] == 0) {
+    TracePrintf(1, "ReleaseFrame: Failed to release frame %d: frame is not allocated\n", frame);
+    return -1;
+  }
+  frame_refcounts[frame]--;
+  if (frame_refcounts[frame] == 0) {
+    return DeallocateFrame(frame);
+  }
+  return 0;
+}
+
+// returns the number of frames that can be allocated without evicting anything
+int NumFreeFrames() {
+  return num_frames - min_frame - num_allocated_frames + num_zeroed_frames;
+}
+
+// returns the number of references to a frame
+int FrameRefCount(int frame) {
+  if (frame < min_frame || frame >= num_frames) {
+    return 0;
+  }
+  return frame_refcounts[frame];
+}
+
+// records that an allocated frame is shared because identical pages were merged into it
+void MarkFrameMerged(int frame) {
+  if (frame >= min_frame && frame < num_frames) {
+    frame_merged[frame] = 1;
+  }
+}
+
+// returns 1 if an allocated frame is shared because identical pages were merged into it
+int IsFrameMerged(int frame) {
+  if (frame < min_frame || frame >= num_frames) {
+    return 0;
+  }
+  return frame_merged[frame];
+}
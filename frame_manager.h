@@ -6,8 +6,15 @@
 #ifndef _frame_manager_h
 #define _frame_manager_h
 
+// number of frames the idle process keeps zeroed ahead of time
+#define ZEROED_FRAME_TARGET 32
+
+// number of frames zeroed on each clock tick spent idle
+#define ZEROED_FRAMES_PER_TICK 4
+
 extern int num_frames;
 extern int num_allocated_frames;
+extern int num_zeroed_frames;
 
 // initializes bit vector to track allocated frames
 int InitializeFrames(int pmem_size);
@@ -18,7 +25,39 @@ int AllocateSpecificFrame(int frame);
 // allocates a previously unallocated frame and returns it
 int AllocateFrame();
 
+// allocates a run of 2^order physically contiguous frames and returns the first one
+int AllocateFrames(int order);
+
+// allocates a frame that contains only zeros and returns it
+// a frame zeroed ahead of time is used if there is one, otherwise a new frame is zeroed now
+int AllocateZeroedFrame();
+
+// zeroes up to count free frames and sets them aside for AllocateZeroedFrame
+// stops early once ZEROED_FRAME_TARGET frames are ready or no frame is free
+void RefillZeroedFrames(int count);
+
 // deallocates a previously allocated frame
 int DeallocateFrame(int frame);
 
+// deallocates a run of 2^order frames previously returned by AllocateFrames
+int DeallocateFrames(int first_frame, int order);
+
+// adds a reference to an allocated frame that is being mapped by another page table entry
+int RetainFrame(int frame);
+
+// drops a reference to an allocated frame, deallocating it when no references remain
+int ReleaseFrame(int frame);
+
+// returns the number of frames that can be allocated without evicting anything
+int NumFreeFrames();
+
+// returns the number of references to a frame
+int FrameRefCount(int frame);
+
+// records that an allocated frame is shared because identical pages were merged into it
+void MarkFrameMerged(int frame);
+
+// returns 1 if an allocated frame is shared because identical pages were merged into it
+int IsFrameMerged(int frame);
+
 #endif
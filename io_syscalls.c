@@ -5,6 +5,7 @@
 
 #include <kernel.h>
 #include <process_controller.h>
+#include <page_fault.h>
 
 // number of lines available to read on each terminal
 int terminal_lines[NUM_TERMINALS];
@@ -28,7 +29,7 @@ KernelTtyRead(int tty_id, void *buf, int len, UserContext *uc)
   while (terminal_lines[tty_id] < 1) {
     // block and switch
     BlockTtyReader(tty_id, curr_pcb);
-    SwitchPCB(uc, 0, NULL);
+    SwitchPCB(uc, SWITCH_BLOCK, NULL);
   }
   terminal_lines[tty_id] -= 1;
 
@@ -36,6 +37,10 @@ KernelTtyRead(int tty_id, void *buf, int len, UserContext *uc)
   int actual_len = TtyReceive(tty_id, string, len);
 
   // copy from kernel buffer to original buffer
+  if (PrepareUserWrite(buf, actual_len) == -1) {
+    free(string);
+    return -1;
+  }
   memcpy(buf, string, actual_len);
   
   free(string);
@@ -73,6 +78,12 @@ KernelTtyWrite(int tty_id, void *buf, int len, UserContext *uc)
     remaining_len -= this_len;
 
     // copy the buffer into kernel memory
+    // each piece is made resident just before it is copied, since earlier pieces
+    // may have been swapped out while this process was blocked
+    if (PrepareUserRead(buf, this_len) == -1) {
+      UnsetTtyWriter(tty_id);
+      return -1;
+    }
     void* string = (void*) malloc(sizeof(char)*this_len);
     memcpy(string, buf, this_len);
 
@@ -80,7 +91,7 @@ KernelTtyWrite(int tty_id, void *buf, int len, UserContext *uc)
     TtyTransmit(tty_id, string, this_len);
 
     // block and switch
-    SwitchPCB(uc, 0, NULL);
+    SwitchPCB(uc, SWITCH_BLOCK, NULL);
 
     // prepare next iteration
     buf += this_len;
@@ -8,12 +8,17 @@
 #include <traps.h>
 #include <yuser.h>
 #include <frame_manager.h>
+#include <buddy_allocator.h>
 #include <pte_manager.h>
 #include <process_controller.h>
 #include <load_program.h>
 #include <kernel.h>
 #include <io_syscalls.h>
 #include <synchronize_syscalls.h>
+#include <page_fault.h>
+#include <swap.h>
+#include <zram.h>
+#include <boot_options.h>
 
 // indicates whether virtual memory has been enabled
 // determines the behavior of SetKernelBrk()
@@ -38,6 +43,7 @@ pcb_t *idle_pcb;
 pcb_t *init_pcb;
 
 // idle program for idle pcb
+// clock ticks that interrupt it are used to zero free frames ahead of time
 void DoIdle(void)
 {
   while (1)
@@ -111,7 +117,27 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt)
   // Enable Virtual Memory subsystem
   is_vm_enabled = 1;
   WriteRegister(REG_VM_ENABLE, 1);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
+  FlushTLB(TLB_FLUSH_0);
+
+  // Leading key=value arguments are kernel options, read before anything they size is set up,
+  // and the rest name the init program and its arguments
+  char **init_args = &cmd_args[ParseBootOptions(cmd_args)];
+
+  // Set up the zero frame shared by untouched heap pages
+  if (InitZeroFrame() == -1) {
+    TracePrintf(1, "KernelStart: failed to initialize zero frame\n");
+    return;
+  }
+
+  // Set up the compressed page store while the kernel heap can still grow without evicting anything
+  if (InitZram() == -1) {
+    TracePrintf(1, "KernelStart: failed to initialize zram, continuing with the swap file only\n");
+  }
+
+  // Set up swap, evicting only to zram if the swap file can't be created
+  if (InitSwap() == -1) {
+    TracePrintf(1, "KernelStart: failed to initialize swap file, continuing with zram only\n");
+  }
 
   // Create init pcb
   init_pcb = NewPCB();
@@ -120,25 +146,22 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt)
   curr_pcb = init_pcb;
 
   // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+  FlushTLB(TLB_FLUSH_0);
+  FlushTLB(TLB_FLUSH_1);
 
   // Set region 1 page table to init
   WriteRegister(REG_PTBR1, (unsigned int) (init_pcb->pt_addr));
   WriteRegister(REG_PTLR1, MAX_PT_LEN);
 
-  char* name = cmd_args[0];
+  char* name = init_args[0];
   if (name == NULL) {
     name = "test/init";
   }
 
-  LoadProgram(name, cmd_args, init_pcb);
+  // LoadProgram flushes region 1 itself
+  LoadProgram(name, init_args, init_pcb);
   *uctxt = init_pcb->uc;
 
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
   InitQueues();
   InitSyncObjects();
   
@@ -159,16 +182,16 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt)
     TracePrintf(1, "KernelStart: failed to populate idle user stack pte \n");
     return;
   }
+  if (AddVMA(&idle_pcb->vmas, VMA_STACK, MAX_PT_LEN-1, MAX_PT_LEN, PROT_READ | PROT_WRITE) == NULL) {
+    TracePrintf(1, "KernelStart: failed to create idle user stack area \n");
+    return;
+  }
 
   if (KernelContextSwitch(KCCopy, idle_pcb, NULL) == -1) {
     TracePrintf(1, "KernelStart: failed to copy init_pcb into idle_pcb\n");
     return;
   }
 
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
   if (curr_pcb == idle_pcb) {
     *uctxt = idle_pcb->uc;
   }
@@ -180,11 +203,11 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt)
 int SetKernelBrk(void *addr)
 {
   TracePrintf(1, "SetKernelBrk: entering\n");
-  // check if addr is above red zone
-  int red_zone = KERNEL_STACK_BASE - (2 * PAGESIZE);
-  if ( addr > (void *) red_zone)
+  // check if addr is above the kmap window, which sits below the red zone under the kernel stack
+  int kmap_base = KMAP_BASE;
+  if ( addr > (void *) kmap_base)
   {
-    TracePrintf(1, "SetKernelBrk: addr %x above red zone %x\n", addr, red_zone);
+    TracePrintf(1, "SetKernelBrk: addr %x above kmap window %x\n", addr, kmap_base);
     return -1;
   }
   // check if addr is below original kernel brk
@@ -204,26 +227,49 @@ int SetKernelBrk(void *addr)
   if (addr >= current_kernel_brk)
   {
     TracePrintf(1, "SetKernelBrk: addr greater than\n");
-    int num_pages = UP_TO_PAGE(addr-current_kernel_brk) >> PAGESHIFT;
     int start_page = UP_TO_PAGE(current_kernel_brk) >> PAGESHIFT;
-    TracePrintf(1, "SetKernelBrk: num_pages=%d\n", num_pages);
+    int end_page = UP_TO_PAGE(addr) >> PAGESHIFT;
+    TracePrintf(1, "SetKernelBrk: num_pages=%d\n", end_page - start_page);
     TracePrintf(1, "SetKernelBrk: start_page=%d\n", start_page);
-    for (int page = start_page; page < start_page+num_pages; page++)
+    int page = start_page;
+    while (page < end_page)
     {
-      int frame = AllocateFrame();
+      // take the largest contiguous run of frames that still fits, falling back to smaller runs
+      int order = 0;
+      while (order < MAX_BUDDY_ORDER && (2 << order) <= end_page - page)
+      {
+        order++;
+      }
+      int frame = AllocateFrames(order);
+      while (frame == -1 && order > 0)
+      {
+        order--;
+        frame = AllocateFrames(order);
+      }
       if (frame == -1)
       {
         TracePrintf(1, "SetKernelBrk: failed to allocate frame \n");
+        // give back the pages mapped so far, leaving the brk and the free frames as they were
+        for (int mapped = start_page; mapped < page; mapped++)
+        {
+          DeallocateFrame(kernel_pt[mapped].pfn);
+          kernel_pt[mapped].valid = 0;
+        }
+        FlushTLB(TLB_FLUSH_0);
         return -1;
       }
-      PopulatePTE(&kernel_pt[page], PROT_READ | PROT_WRITE, frame);
+      for (int i = 0; i < (1 << order); i++)
+      {
+        PopulatePTE(&kernel_pt[page + i], PROT_READ | PROT_WRITE, frame + i);
+      }
+      page += 1 << order;
     }
   // handle case where addr is below current kernel brk
   } else
   {
-    int num_pages = DOWN_TO_PAGE(addr-current_kernel_brk) >> PAGESHIFT;
-    int start_page = (unsigned int)current_kernel_brk >> PAGESHIFT;
-    for (int page = start_page; page > start_page-num_pages; page--)
+    int start_page = UP_TO_PAGE(addr) >> PAGESHIFT;
+    int end_page = UP_TO_PAGE(current_kernel_brk) >> PAGESHIFT;
+    for (int page = start_page; page < end_page; page++)
     {
       int frame = kernel_pt[page].pfn;
       if (DeallocateFrame(frame) == -1)
@@ -233,6 +279,8 @@ int SetKernelBrk(void *addr)
       }
       kernel_pt[page].valid = 0;
     }
+    FlushTLB(TLB_FLUSH_0);
   }
+  current_kernel_brk = addr;
   return 0;
 }
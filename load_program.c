@@ -5,11 +5,100 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <ykernel.h>
 #include <load_info.h>
 
 #include <pcb.h>
+#include <frame_manager.h>
 #include <pte_manager.h>
+#include <text_cache.h>
+#include <vma.h>
+#include <profiler.h>
+
+/*
+ *  Build the list of areas for a program described by "li" whose stack
+ *  takes "stack_npg" pages.  Text and data are not mapped by LoadProgram:
+ *  each area records where its pages live in the file, and their page
+ *  table entries stay invalid so that TrapMemory reads each page in on
+ *  first touch.  The bytes between "li->id_end" and the end of the data
+ *  pages read from the file are bss, and are zeroed when those pages are
+ *  loaded.  The heap runs from the end of bss to the initial brk.
+ */
+static int
+AddProgramVMAs(VMA_t **vmas, struct load_info *li, int stack_npg)
+{
+  VMA_t *vma;
+  int text_pg1 = (li->t_vaddr - VMEM_1_BASE) >> PAGESHIFT;
+  int data_pg1 = (li->id_vaddr - VMEM_1_BASE) >> PAGESHIFT;
+  int heap_pg1 = data_pg1 + li->id_npg + li->ud_npg;
+  int heap_end = ((int) UP_TO_PAGE(li->id_end + PAGESIZE) - VMEM_1_BASE) >> PAGESHIFT;
+  if (heap_end < heap_pg1) {
+    heap_end = heap_pg1;
+  }
+
+  if ((vma = AddVMA(vmas, VMA_TEXT, text_pg1, text_pg1 + li->t_npg, PROT_READ | PROT_EXEC)) == NULL) {
+    FreeVMAs(vmas);
+    return -1;
+  }
+  vma->faddr = li->t_faddr;
+  vma->file_npg = li->t_npg;
+
+  if ((vma = AddVMA(vmas, VMA_DATA, data_pg1, heap_pg1, PROT_READ | PROT_WRITE)) == NULL) {
+    FreeVMAs(vmas);
+    return -1;
+  }
+  vma->faddr = li->id_faddr;
+  vma->file_npg = li->id_npg;
+  vma->zero_from = (void *) li->id_end;
+
+  if (AddVMA(vmas, VMA_HEAP, heap_pg1, heap_end, PROT_READ | PROT_WRITE) == NULL ||
+      AddVMA(vmas, VMA_STACK, MAX_PT_LEN - stack_npg, MAX_PT_LEN, PROT_READ | PROT_WRITE) == NULL) {
+    FreeVMAs(vmas);
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ *  Copy "len" bytes from "src" to the region 1 address "vaddr" on a stack
+ *  that is not mapped yet.  The stack takes the top "stack_npg" pages of
+ *  region 1, and its frames are in "stack_frames", lowest page first.
+ *  Each frame is written through the kmap window.
+ */
+static int
+CopyToStack(int *stack_frames, int stack_npg, void *vaddr, void *src, int len)
+{
+  int offset = (int) vaddr - (VMEM_1_LIMIT - stack_npg * PAGESIZE);
+  while (len > 0) {
+    int n = PAGESIZE - (offset & PAGEOFFSET);
+    if (n > len) {
+      n = len;
+    }
+    char *addr = KMap(stack_frames[offset >> PAGESHIFT]);
+    if (addr == NULL) {
+      return -1;
+    }
+    memcpy(addr + (offset & PAGEOFFSET), src, n);
+    KUnmap(addr);
+    offset += n;
+    src = (char *) src + n;
+    len -= n;
+  }
+  return 0;
+}
+
+/*
+ *  Give back the frames of a stack that was never mapped.
+ */
+static void
+ReleaseStackFrames(int *stack_frames, int n)
+{
+  for (int i = 0; i < n; i++) {
+    DeallocateFrame(stack_frames[i]);
+  }
+  free(stack_frames);
+}
 
 /*
  *  Load a program into an existing address space.  The program comes from
@@ -32,12 +121,14 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
   char *cp2;
   int argcount;
   int size;
-  int text_pg1;
   int data_pg1;
   int data_npg;
   int stack_npg;
-  long segment_size;
-  char *argbuf;
+  int *stack_frames;
+  int rc;
+  struct stat st;
+  TextImage_t *text_image;
+  VMA_t *vmas = NULL;
 
   
   /*
@@ -60,11 +151,20 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
     return ERROR;
   }
 
+  /*
+   * Identify the file so that its text can be shared with other
+   * processes already running the same executable
+   */
+  if (fstat(fd, &st) < 0) {
+    TracePrintf(0, "LoadProgram: can't stat file '%s'\n", name);
+    close(fd);
+    return ERROR;
+  }
+
   /*
    * Figure out in what region 1 page the different program sections
    * start and end
    */
-  text_pg1 = (li.t_vaddr - VMEM_1_BASE) >> PAGESHIFT;
   data_pg1 = (li.id_vaddr - VMEM_1_BASE) >> PAGESHIFT;
   data_npg = li.id_npg + li.ud_npg;
   /*
@@ -141,23 +241,74 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
   proc->uc.sp = cp2;
 
   /*
-   * Now save the arguments in a separate buffer in region 0, since
-   * we are about to blow away all of region 1.
+   * Allocate the frames of the new stack and build the argument list in
+   * them now, through the kmap window, while the arguments are still
+   * mapped in the old region 1.  The frames come from AllocateZeroedFrame,
+   * so the NULL pointers that end argv and envp are already there.
    */
-  cp2 = argbuf = (char *)malloc(size);
+  stack_frames = (int *)malloc(stack_npg * sizeof(int));
+  if (stack_frames == NULL) {
+    TracePrintf(1, "LoadProgram: failed to malloc stack frames\n");
+    close(fd);
+    return ERROR;
+  }
+  for (i = 0; i < stack_npg; i++) {
+    stack_frames[i] = AllocateZeroedFrame();
+    if (stack_frames[i] == -1) {
+      TracePrintf(1, "LoadProgram: failed to allocate stack frame %d\n", i);
+      ReleaseStackFrames(stack_frames, i);
+      close(fd);
+      return ERROR;
+    }
+  }
 
-  /* 
-   * ==>> You should perhaps check that malloc returned valid space 
+  rc = CopyToStack(stack_frames, stack_npg, cpp++, &argcount, sizeof(int));	/* the first value at cpp is argc */
+  for (i = 0; rc == 0 && i < argcount; i++) {      /* copy each argument and set argv */
+    TracePrintf(3, "saving arg %d = '%s'\n", i, args[i]);
+    int len = strlen(args[i]) + 1;
+    rc = CopyToStack(stack_frames, stack_npg, cpp++, &cp, sizeof(char *));
+    if (rc == 0) {
+      rc = CopyToStack(stack_frames, stack_npg, cp, args[i], len);
+    }
+    cp += len;
+  }
+  if (rc == -1) {
+    TracePrintf(1, "LoadProgram: failed to copy arguments onto the new stack\n");
+    ReleaseStackFrames(stack_frames, stack_npg);
+    close(fd);
+    return ERROR;
+  }
+
+  /*
+   * Describe the new region 1 as a list of areas, before anything of the
+   * old one is thrown away.
    */
-  if (cp2 == NULL) {
-    TracePrintf(1, "LoadProgram: failed to malloc cp2\n");
+  if (AddProgramVMAs(&vmas, &li, stack_npg) == -1) {
+    TracePrintf(1, "LoadProgram: failed to create areas for '%s'\n", name);
+    close(fd);
+    ReleaseStackFrames(stack_frames, stack_npg);
     return ERROR;
   }
 
-  for (i = 0; args[i] != NULL; i++) {
-    TracePrintf(3, "saving arg %d = '%s'\n", i, args[i]);
-    strcpy(cp2, args[i]);
-    cp2 += strlen(cp2) + 1;
+  /*
+   * Find the cached image of this executable, or cache it now.  The
+   * image keeps the file open so that text and data pages can be read
+   * in as the process touches them.  This has to happen before region 1
+   * is thrown away, since "name" may live there.
+   */
+  text_image = FindTextImage(name, &st);
+  if (text_image != NULL && text_image->t_npg == li.t_npg) {
+    TracePrintf(1, "LoadProgram: sharing cached image of '%s'\n", name);
+    close(fd);
+  } else {
+    text_image = CreateTextImage(name, &st, fd, li.t_npg);
+    if (text_image == NULL) {
+      TracePrintf(1, "LoadProgram: failed to cache image of '%s'\n", name);
+      close(fd);
+      ReleaseStackFrames(stack_frames, stack_npg);
+      FreeVMAs(&vmas);
+      return ERROR;
+    }
   }
 
   /*
@@ -172,112 +323,34 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    */
   pte_t* pt = proc->pt_addr;
 
-  ClearPT(pt);
+  // retain the new image before releasing the old one, which may be the same image
+  RetainTextImage(text_image);
+  DumpProfile(proc);
+  ClearAddressSpace(proc);
+  ReleaseTextImage(proc->text_image);
+  proc->text_image = text_image;
+  proc->vmas = vmas;
 
   /*
    * ==>> Then, build up the new region1.  
    * ==>> (See the LoadProgram diagram in the manual.)
    */
-  int rc;
-  /*
-   * ==>> First, text. Allocate "li.t_npg" physical pages and map them starting at
-   * ==>> the "text_pg1" page in region 1 address space.
-   * ==>> These pages should be marked valid, with a protection of
-   * ==>> (PROT_READ | PROT_WRITE).
-   */
-
-  rc = PopulatePTERegion(pt, text_pg1, text_pg1 + li.t_npg, PROT_READ | PROT_WRITE);
-  if (rc == -1) {
-    TracePrintf(1, "LoadProgram: failed create text PTE region\n");
-    return ERROR;
-  }
-
-  /*
-   * ==>> Then, data. Allocate "data_npg" physical pages and map them starting at
-   * ==>> the  "data_pg1" in region 1 address space.
-   * ==>> These pages should be marked valid, with a protection of
-   * ==>> (PROT_READ | PROT_WRITE).
-   */
-  rc = PopulatePTERegion(pt, data_pg1, data_pg1 + data_npg, PROT_READ | PROT_WRITE);
-  if (rc == -1) {
-    TracePrintf(1, "LoadProgram: failed create data PTE region\n");
-    return ERROR;
-  }
 
   /* 
-   * ==>> Then, stack. Allocate "stack_npg" physical pages and map them to the top
-   * ==>> of the region 1 virtual address space.
+   * ==>> Then, stack.  Map the "stack_npg" frames that already hold the
+   * ==>> arguments to the top of the region 1 virtual address space.
    * ==>> These pages should be marked valid, with a
    * ==>> protection of (PROT_READ | PROT_WRITE).
    */
-  rc = PopulatePTERegion(pt, MAX_PT_LEN - stack_npg, MAX_PT_LEN, PROT_READ | PROT_WRITE);
-  if (rc == -1) {
-    TracePrintf(1, "LoadProgram: failed create stack PTE region\n");
-    return ERROR;
+  for (i = 0; i < stack_npg; i++) {
+    PopulatePTE(&pt[MAX_PT_LEN - stack_npg + i], PROT_READ | PROT_WRITE, stack_frames[i]);
   }
+  free(stack_frames);
 
   /*
    * ==>> (Finally, make sure that there are no stale region1 mappings left in the TLB!)
    */
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-  /*
-   * All pages for the new address space are now in the page table.  
-   */
-
-  /*
-   * Read the text from the file into memory.
-   */
-  lseek(fd, li.t_faddr, SEEK_SET);
-  segment_size = li.t_npg << PAGESHIFT;
-  if (read(fd, (void *) li.t_vaddr, segment_size) != segment_size) {
-    close(fd);
-    return KILL;   // see ykernel.h
-  }
-
-  /*
-   * Read the data from the file into memory.
-   */
-  lseek(fd, li.id_faddr, 0);
-  segment_size = li.id_npg << PAGESHIFT;
-
-  if (read(fd, (void *) li.id_vaddr, segment_size) != segment_size) {
-    close(fd);
-    return KILL;
-  }
-
-
-  close(fd);			/* we've read it all now */
-
-
-  /*
-   * ==>> Above, you mapped the text pages as writable, so this code could write
-   * ==>> the new text there.
-   *
-   * ==>> But now, you need to change the protections so that the machine can execute
-   * ==>> the text.
-   *
-   * ==>> For each text page in region1, change the protection to (PROT_READ | PROT_EXEC).
-   * ==>> If any of these page table entries is also in the TLB, 
-   * ==>> you will need to flush the old mapping. 
-   */
-
-  for (int page = text_pg1; page < text_pg1 + li.t_npg; page++)
-  {
-    pte_t *pte = &pt[page];
-    if (pte == NULL) {
-      TracePrintf(1, "LoadProgram: text PTE at page %d is NULL\n", page);
-      return ERROR;
-    }
-    pte->prot = PROT_READ | PROT_EXEC;
-  }
-
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-  
-  /*
-   * Zero out the uninitialized data area
-   */
-  bzero((void *) li.id_end, li.ud_end - li.id_end);
+  FlushTLB(TLB_FLUSH_1);
 
   /*
    * Set the entry point in the process's UserContext
@@ -289,25 +362,6 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    */
   proc->uc.pc = (void *) li.entry;
 
-  /*
-   * Now, finally, build the argument list on the new stack.
-   */
-
-
-  memset(cpp, 0x00, VMEM_1_LIMIT - ((int) cpp));
-
-  *cpp++ = (char *)argcount;		/* the first value at cpp is argc */
-  cp2 = argbuf;
-  for (i = 0; i < argcount; i++) {      /* copy each argument and set argv */
-    *cpp++ = cp;
-    strcpy(cp, cp2);
-    cp += strlen(cp) + 1;
-    cp2 += strlen(cp2) + 1;
-  }
-  free(argbuf);
-  *cpp++ = NULL;			/* the last argv is a NULL pointer */
-  *cpp++ = NULL;			/* a NULL pointer for an empty envp */
-
   void *brk = (void *) (li.id_end + PAGESIZE);
   proc->orig_brk = brk;
   proc->brk = brk;
@@ -315,4 +369,3 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
   TracePrintf(1, "LoadProgram: returning SUCCESS\n");
   return SUCCESS;
 }
-
@@ -0,0 +1,140 @@
+// Contains the multilevel feedback queue scheduling policy, see scheduler.h
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <kernel.h>
+#include <queue.h>
+#include <mlfq.h>
+#include <scheduler.h>
+
+// ready processes at each level, and a bitmap with bit i set while level i is nonempty
+Queue_t *mlfq_levels[MLFQ_LEVELS];
+unsigned int mlfq_bitmap = 0;
+
+// clock ticks until every process is moved back to level 0
+int mlfq_ticks_to_boost = MLFQ_BOOST_TICKS;
+
+int num_mlfq_demotions = 0;
+int num_mlfq_wake_boosts = 0;
+int num_mlfq_aging_boosts = 0;
+
+// creates an empty queue for each level
+void InitMLFQ() {
+  for (int level = 0; level < MLFQ_LEVELS; level++) {
+    mlfq_levels[level] = createQueue();
+  }
+  mlfq_bitmap = 0;
+}
+
+// adds a ready process behind every other process at its level
+int MLFQEnqueue(pcb_t *pcb) {
+  if (enQueue(mlfq_levels[pcb->sched_level], pcb) == -1) {
+    return -1;
+  }
+  mlfq_bitmap |= 1 << pcb->sched_level;
+  return 0;
+}
+
+// adds a ready process ahead of every other process at its level
+int MLFQEnqueueFront(pcb_t *pcb) {
+  if (enQueueFront(mlfq_levels[pcb->sched_level], pcb) == -1) {
+    return -1;
+  }
+  mlfq_bitmap |= 1 << pcb->sched_level;
+  return 0;
+}
+
+// removes and returns the first process of the highest nonempty level, NULL if none is ready
+// the lowest set bit of the bitmap is that level, so finding it does not depend on how many levels there are
+pcb_t *MLFQDequeue() {
+  if (mlfq_bitmap == 0) {
+    return NULL;
+  }
+  int level = __builtin_ctz(mlfq_bitmap);
+  pcb_t *pcb = deQueue(mlfq_levels[level]);
+  if (mlfq_levels[level]->front == NULL) {
+    mlfq_bitmap &= ~(1 << level);
+  }
+  return pcb;
+}
+
+// moves every process, ready or not, back to level 0 with a fresh quantum
+void AgeAllPCBs() {
+  for (int level = 1; level < MLFQ_LEVELS; level++) {
+    pcb_t *pcb = deQueue(mlfq_levels[level]);
+    while (pcb != NULL) {
+      enQueue(mlfq_levels[0], pcb);
+      pcb = deQueue(mlfq_levels[level]);
+    }
+  }
+  if (mlfq_bitmap != 0) {
+    mlfq_bitmap = 1;
+  }
+  for (pcb_t *pcb = all_pcbs; pcb != NULL; pcb = pcb->all_next) {
+    pcb->sched_level = 0;
+    pcb->sched_ticks = 0;
+  }
+  num_mlfq_aging_boosts++;
+}
+
+// charges a clock tick to the running process, demoting it once it has used up the quantum of its level
+// returns 1 if it should give up the cpu
+int MLFQTick(pcb_t *pcb) {
+  mlfq_ticks_to_boost--;
+  if (mlfq_ticks_to_boost <= 0) {
+    mlfq_ticks_to_boost = MLFQ_BOOST_TICKS;
+    AgeAllPCBs();
+  }
+
+  // the idle process only runs while nothing else is ready
+  if (pcb == idle_pcb) {
+    return 1;
+  }
+
+  pcb->sched_ticks++;
+  if (pcb->sched_ticks >= MLFQ_QUANTUM(pcb)) {
+    if (pcb->sched_level < MLFQ_LEVELS - 1) {
+      pcb->sched_level++;
+      num_mlfq_demotions++;
+    }
+    pcb->sched_ticks = 0;
+    return 1;
+  }
+
+  // a process at a higher level preempts this one before its quantum is up
+  return (mlfq_bitmap & ((1 << pcb->sched_level) - 1)) != 0;
+}
+
+// starts a fresh quantum for a process that is about to block, on whatever it blocks on
+void MLFQBlock(pcb_t *pcb) {
+  pcb->sched_ticks = 0;
+}
+
+// moves a process that is woken up after blocking to level 0
+void MLFQBoost(pcb_t *pcb) {
+  if (pcb->sched_level > 0) {
+    num_mlfq_wake_boosts++;
+  }
+  pcb->sched_level = 0;
+  pcb->sched_ticks = 0;
+}
+
+// prints how often processes were demoted, boosted on wake up and aged back to the top
+void PrintMLFQStats() {
+  TracePrintf(0, "mlfq: %d demotions, %d wake up boosts, %d aging boosts\n",
+              num_mlfq_demotions, num_mlfq_wake_boosts, num_mlfq_aging_boosts);
+}
+
+SchedOps_t mlfq_sched_ops = {
+  "mlfq",
+  InitMLFQ,
+  MLFQEnqueue,
+  MLFQEnqueueFront,
+  MLFQDequeue,
+  MLFQTick,
+  MLFQBlock,
+  MLFQBoost,
+  PrintMLFQStats
+};
@@ -0,0 +1,52 @@
+// Contains the multilevel feedback queue scheduling policy, see scheduler.h
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _mlfq_h
+#define _mlfq_h
+
+#include <ykernel.h>
+#include <pcb.h>
+
+// number of priority levels, level 0 runs first
+#define MLFQ_LEVELS 4
+
+
+// every MLFQ_BOOST_TICKS clock ticks every process is moved back to level 0, so that none starves
+#define MLFQ_BOOST_TICKS 50
+
+// number of clock ticks a process at a level may run before it is demoted
+// a process runs for its own quantum at level 0, doubling at each lower level
+#define MLFQ_QUANTUM(pcb) (SchedQuantum(pcb) << (pcb)->sched_level)
+
+// creates an empty queue for each level
+void InitMLFQ();
+
+// adds a ready process behind every other process at its level, returns -1 if it is already queued
+int MLFQEnqueue(pcb_t *pcb);
+
+// adds a ready process ahead of every other process at its level, returns -1 if it is already queued
+int MLFQEnqueueFront(pcb_t *pcb);
+
+// removes and returns the first process of the highest nonempty level, NULL if none is ready
+pcb_t *MLFQDequeue();
+
+// charges a clock tick to the running process, demoting it once it has used up the quantum of its level,
+// and moves every process back to level 0 every MLFQ_BOOST_TICKS ticks
+// returns 1 if the running process should give up the cpu, either because its quantum ran out or
+// because a process at a higher level is ready, and 0 if it should keep running
+int MLFQTick(pcb_t *pcb);
+
+// starts a fresh quantum for a process that is about to block, on whatever it blocks on, so that the
+// ticks it ran before blocking are not charged against it when it next runs
+void MLFQBlock(pcb_t *pcb);
+
+// moves a process that is woken up after blocking on a terminal, pipe, lock or cvar to level 0,
+// so that interactive processes stay ahead of ones that use their whole quantum
+void MLFQBoost(pcb_t *pcb);
+
+// prints how often processes were demoted, boosted on wake up and aged back to the top
+void PrintMLFQStats();
+
+#endif
@@ -0,0 +1,414 @@
+// Contains page fault resolution for region 1 of the current process
+//
+// Andrew Chen
+// 10/2026
+
+#include <unistd.h>
+#include <ykernel.h>
+#include <kernel.h>
+#include <frame_manager.h>
+#include <pte_manager.h>
+#include <page_fault.h>
+#include <swap.h>
+#include <dedup.h>
+#include <boot_options.h>
+
+// frame of zeros mapped read only at every heap page that has been read but never written
+// the kernel keeps its own reference, so it is never freed or written in place
+int zero_frame = -1;
+
+// allocates and zeroes the shared zero frame
+int InitZeroFrame() {
+  zero_frame = AllocateZeroedFrame();
+  if (zero_frame == -1) {
+    TracePrintf(1, "InitZeroFrame: failed to allocate zero frame\n");
+    return -1;
+  }
+  return 0;
+}
+
+// gives the current process a private, writable copy of a copy-on-write region 1 page
+int BreakCOW(int page) {
+  pte_t *pt = curr_pcb->pt_addr;
+  pte_t *pte = &pt[page];
+  if (pte->valid == 0 || pte->prot != COW_PROT) {
+    TracePrintf(1, "BreakCOW: page %d is not copy-on-write\n", page);
+    return -1;
+  }
+  // a read only page looks the same in the page table, so only the area says whether the page may be written
+  VMA_t *vma = FindVMA(curr_pcb->vmas, page);
+  if (vma == NULL || (vma->prot & PROT_WRITE) == 0) {
+    TracePrintf(1, "BreakCOW: page %d is in no writable area\n", page);
+    return -1;
+  }
+  void *page_addr = REGION_1_PAGE_ADDR(page);
+
+  // the other sharers are gone, so the frame can simply be made writable again
+  if (FrameRefCount(pte->pfn) == 1) {
+    pte->prot = PROT_READ | PROT_WRITE;
+    FlushTLB((unsigned int) page_addr);
+    return 0;
+  }
+
+  // a copy of the zero frame is just a zeroed frame, so nothing needs to be copied
+  if (pte->pfn == zero_frame) {
+    int frame = AllocateZeroedFrame();
+    if (frame == -1) {
+      TracePrintf(1, "BreakCOW: failed to allocate zeroed frame for page %d\n", page);
+      return -1;
+    }
+    ReleaseFrame(zero_frame);
+    pte->pfn = frame;
+    pte->prot = PROT_READ | PROT_WRITE;
+    FlushTLB((unsigned int) page_addr);
+    return 0;
+  }
+
+  // otherwise copy just this page into a new frame
+  if (IsFrameMerged(pte->pfn)) {
+    num_dedup_unmerges++;
+  }
+  int frame = AllocateFrame();
+  if (frame == -1) {
+    TracePrintf(1, "BreakCOW: failed to allocate frame for page %d\n", page);
+    return -1;
+  }
+
+  void *copy = KMap(frame);
+  if (copy == NULL) {
+    DeallocateFrame(frame);
+    return -1;
+  }
+  memcpy(copy, page_addr, PAGESIZE);
+  KUnmap(copy);
+
+  ReleaseFrame(pte->pfn);
+  pte->pfn = frame;
+  pte->prot = PROT_READ | PROT_WRITE;
+  FlushTLB((unsigned int) page_addr);
+  return 0;
+}
+
+// unmaps the region 1 pages [start, end) mapped by a LoadFilePages that failed part way
+// each page is invalidated in the TLB before its frame is freed, so no stale translation to a free frame is left
+void UnmapFilePages(pte_t *pt, int start, int end) {
+  for (int page = start; page < end; page++) {
+    if (pt[page].valid == 0) {
+      continue;
+    }
+    int pfn = pt[page].pfn;
+    pt[page].valid = 0;
+    pt[page].prot = 0;
+    pt[page].pfn = 0;
+    FlushTLB((unsigned int) REGION_1_PAGE_ADDR(page));
+    ReleaseFrame(pfn);
+  }
+}
+
+// maps new frames at the invalid region 1 pages [start, end) of the current process and fills them
+// from the segment of the executable starting at page seg_pg1 and file offset faddr
+// pages at or past seg_pg1 + file_npg, and bytes at or past zero_from, are zero filled instead
+int LoadFilePages(int start, int end, int seg_pg1, int file_npg, long faddr, void *zero_from, int prot) {
+  pte_t *pt = curr_pcb->pt_addr;
+  int fd = curr_pcb->text_image->fd;
+
+  // pages in [start, file_end) are read from the file, the rest are entirely zero
+  int file_end = seg_pg1 + file_npg;
+  if (file_end > end) {
+    file_end = end;
+  }
+  if (file_end < start) {
+    file_end = start;
+  }
+
+  // map every page writable so that the kernel can fill it
+  for (int page = start; page < end; page++) {
+    int frame = page < file_end ? AllocateFrame() : AllocateZeroedFrame();
+    if (frame == -1) {
+      TracePrintf(1, "LoadFilePages: failed to allocate frame for page %d\n", page);
+      UnmapFilePages(pt, start, page);
+      return -1;
+    }
+    PopulatePTE(&pt[page], PROT_READ | PROT_WRITE, frame);
+    FlushTLB((unsigned int) REGION_1_PAGE_ADDR(page));
+  }
+
+  // read every page backed by the file with a single read
+  if (file_end > start) {
+    long size = (long) (file_end - start) << PAGESHIFT;
+    lseek(fd, faddr + ((long) (start - seg_pg1) << PAGESHIFT), SEEK_SET);
+    if (read(fd, REGION_1_PAGE_ADDR(start), size) != size) {
+      TracePrintf(1, "LoadFilePages: failed to read pages %d to %d\n", start, file_end);
+      UnmapFilePages(pt, start, end);
+      return -1;
+    }
+  }
+
+  // zero the bytes read past zero_from, the pages after file_end came zeroed
+  void *zero_end = REGION_1_PAGE_ADDR(file_end);
+  if (zero_from != NULL && zero_from >= REGION_1_PAGE_ADDR(start) && zero_from < zero_end) {
+    bzero(zero_from, zero_end - zero_from);
+  }
+
+  for (int page = start; page < end; page++) {
+    pt[page].prot = prot;
+    FlushTLB((unsigned int) REGION_1_PAGE_ADDR(page));
+  }
+  return 0;
+}
+
+// maps a heap or stack page of the current process that has never been touched
+// a read only needs the shared zero frame, while a write gets a private zeroed frame
+int MapAnonPage(int page, int write) {
+  pte_t *pt = curr_pcb->pt_addr;
+  void *page_addr = REGION_1_PAGE_ADDR(page);
+  if (!write) {
+    PopulatePTE(&pt[page], COW_PROT, zero_frame);
+    RetainFrame(zero_frame);
+    FlushTLB((unsigned int) page_addr);
+    return 0;
+  }
+  int frame = AllocateZeroedFrame();
+  if (frame == -1) {
+    TracePrintf(1, "MapAnonPage: failed to allocate frame for page %d\n", page);
+    return -1;
+  }
+  PopulatePTE(&pt[page], PROT_READ | PROT_WRITE, frame);
+  FlushTLB((unsigned int) page_addr);
+  return 0;
+}
+
+// reads the page of the executable mapped at a region 1 page of the current process, along with its neighbours
+// returns -1 if the page is not part of the executable or could not be loaded
+int LoadExecutablePage(int page) {
+  TextImage_t *image = curr_pcb->text_image;
+  pte_t *pt = curr_pcb->pt_addr;
+  VMA_t *vma = FindVMA(curr_pcb->vmas, page);
+  if (image == NULL || vma == NULL || (vma->kind != VMA_TEXT && vma->kind != VMA_DATA)) {
+    return -1;
+  }
+  int seg_pg1 = vma->start;
+  int seg_end = vma->end;
+  int is_text = (vma->kind == VMA_TEXT);
+
+  // fault around: bring in the aligned group of pages within the segment that contains the faulting page
+  int window_start = seg_pg1 + ((page - seg_pg1) / FAULT_AROUND_PAGES) * FAULT_AROUND_PAGES;
+  int window_end = window_start + FAULT_AROUND_PAGES;
+  if (window_end > seg_end) {
+    window_end = seg_end;
+  }
+
+  int run_start = window_start;
+  while (run_start < window_end) {
+    if (pt[run_start].valid == 1) {
+      run_start++;
+      continue;
+    }
+
+    // text pages already read by another process are shared instead of read again
+    if (is_text && image->pfns[run_start - seg_pg1] != -1) {
+      int pfn = image->pfns[run_start - seg_pg1];
+      PopulatePTE(&pt[run_start], PROT_READ | PROT_EXEC, pfn);
+      RetainFrame(pfn);
+      FlushTLB((unsigned int) REGION_1_PAGE_ADDR(run_start));
+      run_start++;
+      continue;
+    }
+
+    // otherwise read the whole run of missing pages at once
+    int run_end = run_start + 1;
+    while (run_end < window_end && pt[run_end].valid == 0 &&
+           (!is_text || image->pfns[run_end - seg_pg1] == -1)) {
+      run_end++;
+    }
+    int rc = LoadFilePages(run_start, run_end, seg_pg1, vma->file_npg, vma->faddr, vma->zero_from, vma->prot);
+    if (rc == -1) {
+      // neighbours are only an optimization, but the faulting page itself must load
+      if (page >= run_start && page < run_end) {
+        return -1;
+      }
+      break;
+    }
+
+    // publish newly read text so that other processes running this executable share it
+    if (is_text) {
+      for (int loaded = run_start; loaded < run_end; loaded++) {
+        image->pfns[loaded - seg_pg1] = pt[loaded].pfn;
+        RetainFrame(pt[loaded].pfn);
+      }
+    }
+    run_start = run_end;
+  }
+
+  TracePrintf(1, "LoadExecutablePage: loaded pages %d to %d for pid %d\n", window_start, window_end, curr_pcb->pid);
+  return pt[page].valid == 1 ? 0 : -1;
+}
+
+// extends the stack area of the current process down to cover a faulting page below it
+// stack_prefault_pages further pages are mapped at the same time, so a deep call chain only faults
+// once every few pages, but the stack never grows past stack_limit_pages or into the red zone above the heap
+// returns -1 if the page is neither within STACK_GROWTH_PAGES of the stack nor near the user stack pointer,
+// or the stack would get too large
+int GrowStack(int page) {
+  VMA_t *stack = FindVMAKind(curr_pcb->vmas, VMA_STACK);
+  if (stack == NULL || page >= stack->start) {
+    return -1;
+  }
+
+  // a frame with large locals moves the stack pointer down before touching them, so a fault at or
+  // just below the stack pointer is the stack too, and anything further down is a wild pointer
+  void *sp = curr_pcb->user_sp;
+  int near_sp = sp >= (void *) VMEM_1_BASE + STACK_SP_SLACK && sp < (void *) VMEM_1_LIMIT &&
+                page >= REGION_1_PAGE(sp - STACK_SP_SLACK);
+  if (page < stack->start - STACK_GROWTH_PAGES && !near_sp) {
+    TracePrintf(1, "GrowStack: page %d is too far below the stack at page %d for pid %d\n", page, stack->start, curr_pcb->pid);
+    return -1;
+  }
+
+  // the page just above the area below the stack stays unmapped as a red zone
+  int lowest = MAX_PT_LEN - stack_limit_pages;
+  for (VMA_t *vma = curr_pcb->vmas; vma != stack; vma = vma->next) {
+    if (vma->end + 1 > lowest) {
+      lowest = vma->end + 1;
+    }
+  }
+  if (page < lowest) {
+    TracePrintf(1, "GrowStack: page %d is below the lowest stack page %d for pid %d\n", page, lowest, curr_pcb->pid);
+    return -1;
+  }
+
+  int new_start = page - stack_prefault_pages;
+  if (new_start < lowest) {
+    new_start = lowest;
+  }
+  pte_t *pt = curr_pcb->pt_addr;
+  if (PopulatePTERegion(pt, new_start, stack->start, PROT_READ | PROT_WRITE) == -1) {
+    // the extra pages are only an optimization, so retry with just what the fault needs
+    new_start = page;
+    if (PopulatePTERegion(pt, new_start, stack->start, PROT_READ | PROT_WRITE) == -1) {
+      TracePrintf(1, "GrowStack: failed to map stack pages %d to %d\n", new_start, stack->start);
+      return -1;
+    }
+  }
+  TracePrintf(1, "GrowStack: stack of pid %d grew from page %d to %d\n", curr_pcb->pid, stack->start, new_start);
+  // the new pages were all invalid before, so only they need invalidating in the TLB
+  for (int p = new_start; p < stack->start; p++) {
+    FlushTLB((unsigned int) REGION_1_PAGE_ADDR(p));
+  }
+  stack->start = new_start;
+  return 0;
+}
+
+// maps a region 1 page of the current process that is part of its address space but is not resident,
+// either because it has never been touched or because it was sampled or swapped out
+// a page just below the stack grows the stack instead
+// returns -1 if the page is not inside any of its areas
+int FaultInPage(int page, int write) {
+  if (curr_pcb->page_state[page] != PAGE_RESIDENT) {
+    return RestorePage(page);
+  }
+  VMA_t *vma = FindVMA(curr_pcb->vmas, page);
+  if (vma == NULL) {
+    return GrowStack(page);
+  }
+  if (vma->kind == VMA_TEXT || vma->kind == VMA_DATA) {
+    return LoadExecutablePage(page);
+  }
+  return MapAnonPage(page, write);
+}
+
+// resolves a fault at addr in region 1 of the current process, either by mapping a page of the
+// executable, heap or stack that has not been touched yet or by copying a copy-on-write page
+// returns 0 if the access can be retried, -1 if the fault is a real violation
+int ResolvePageFault(void *addr) {
+  if (addr < (void *) VMEM_1_BASE || addr >= (void *) VMEM_1_LIMIT) {
+    return -1;
+  }
+  int page = REGION_1_PAGE(addr);
+  pte_t *pt = curr_pcb->pt_addr;
+  if (pt[page].valid == 0) {
+    // the fault does not say whether it was a write, and most untouched heap and stack pages are
+    // written first, so they get a private frame while the idle loop keeps pre-zeroed ones aside;
+    // only with the pool empty does the page start as the zero frame and pay a second fault to copy
+    return FaultInPage(page, num_zeroed_frames > 0);
+  }
+  if (pt[page].prot == COW_PROT) {
+    TracePrintf(1, "ResolvePageFault: copying page %d for pid %d\n", page, curr_pcb->pid);
+    return BreakCOW(page);
+  }
+  return -1;
+}
+
+// makes every page in [addr, addr + len) of the current process resident,
+// and privately writable if write is set
+int PrepareUserAccess(void *addr, int len, int write) {
+  if (len <= 0) {
+    return 0;
+  }
+  if (addr < (void *) VMEM_1_BASE || addr + len > (void *) VMEM_1_LIMIT || addr + len < addr) {
+    TracePrintf(1, "PrepareUserAccess: buffer %x is not in region 1\n", addr);
+    return -1;
+  }
+  pte_t *pt = curr_pcb->pt_addr;
+  int start_page = REGION_1_PAGE(addr);
+  int end_page = REGION_1_PAGE(addr + len - 1);
+  for (int page = start_page; page <= end_page; page++) {
+    if (pt[page].valid == 0 && FaultInPage(page, write) == -1) {
+      TracePrintf(1, "PrepareUserAccess: page %d is not mapped\n", page);
+      return -1;
+    }
+    if (write && pt[page].prot == COW_PROT && BreakCOW(page) == -1) {
+      return -1;
+    }
+    if (write && (pt[page].prot & PROT_WRITE) == 0) {
+      TracePrintf(1, "PrepareUserAccess: page %d is not writable\n", page);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// makes every page in [addr, addr + len) of the current process resident
+// so that the kernel can read a user buffer without faulting
+int PrepareUserRead(void *addr, int len) {
+  return PrepareUserAccess(addr, len, 0);
+}
+
+// makes every page in [addr, addr + len) of the current process resident and privately writable
+// so that the kernel can write into a user buffer without faulting
+int PrepareUserWrite(void *addr, int len) {
+  return PrepareUserAccess(addr, len, 1);
+}
+
+// makes every page of a NUL terminated user string resident
+int PrepareUserString(char *str) {
+  char *cp = str;
+  while (1) {
+    // make the rest of the page resident, then look for the end of the string in it
+    char *page_end = (char *) UP_TO_PAGE(cp + 1);
+    if (PrepareUserRead(cp, page_end - cp) == -1) {
+      return -1;
+    }
+    while (cp < page_end) {
+      if (*cp == '\0') {
+        return 0;
+      }
+      cp++;
+    }
+  }
+}
+
+// makes a NULL terminated user argument vector and every string in it resident
+int PrepareUserArgv(char **argv) {
+  for (int i = 0; ; i++) {
+    if (PrepareUserRead(&argv[i], sizeof(char *)) == -1) {
+      return -1;
+    }
+    if (argv[i] == NULL) {
+      return 0;
+    }
+    if (PrepareUserString(argv[i]) == -1) {
+      return -1;
+    }
+  }
+}
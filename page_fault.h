@@ -0,0 +1,78 @@
+// Contains page fault resolution for region 1 of the current process
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _page_fault_h
+#define _page_fault_h
+
+#include <ykernel.h>
+
+// a valid region 1 page whose protection is exactly COW_PROT is writable, but its frame
+// is shared copy-on-write with another page table, so a write fault on it is not a violation
+#define COW_PROT PROT_READ
+
+// number of neighbouring pages of the executable brought in together with a faulting page
+#define FAULT_AROUND_PAGES 4
+
+// a fault this many pages below the stack, or at most STACK_SP_SLACK bytes below the user stack pointer,
+// grows the stack, and a fault anywhere else between the heap and the stack is a violation
+#define STACK_GROWTH_PAGES 4
+#define STACK_SP_SLACK 256
+
+// index into a region 1 page table of the page containing addr
+#define REGION_1_PAGE(addr) ((int) (((unsigned int) (addr)) >> PAGESHIFT) - MAX_PT_LEN)
+
+// address of the start of a region 1 page
+#define REGION_1_PAGE_ADDR(page) ((void *) (((page) + MAX_PT_LEN) << PAGESHIFT))
+
+// frame of zeros mapped read only at every heap page that has been read but never written
+extern int zero_frame;
+
+// allocates and zeroes the shared zero frame
+int InitZeroFrame();
+
+// gives the current process a private, writable copy of a copy-on-write region 1 page
+int BreakCOW(int page);
+
+// reads the page of the executable mapped at a region 1 page of the current process, along with its neighbours
+// returns -1 if the page is not part of the executable or could not be loaded
+int LoadExecutablePage(int page);
+
+// maps a heap or stack page of the current process that has never been touched
+// a read only needs the shared zero frame, while a write gets a private zeroed frame
+int MapAnonPage(int page, int write);
+
+// extends the stack area of the current process down to cover a faulting page below it
+// stack_prefault_pages further pages are mapped at the same time, so a deep call chain only faults
+// once every few pages, but the stack never grows past stack_limit_pages or into the red zone above the heap
+// returns -1 if the page is neither within STACK_GROWTH_PAGES of the stack nor near the user stack pointer,
+// or the stack would get too large
+int GrowStack(int page);
+
+// maps a region 1 page of the current process that is part of its address space but is not resident,
+// either because it has never been touched or because it was sampled or swapped out
+// a page just below the stack grows the stack instead
+// returns -1 if the page is not inside any of its areas
+int FaultInPage(int page, int write);
+
+// resolves a fault at addr in region 1 of the current process, either by mapping a page of the
+// executable, heap or stack that has not been touched yet or by copying a copy-on-write page
+// returns 0 if the access can be retried, -1 if the fault is a real violation
+int ResolvePageFault(void *addr);
+
+// makes every page in [addr, addr + len) of the current process resident
+// so that the kernel can read a user buffer without faulting
+int PrepareUserRead(void *addr, int len);
+
+// makes every page in [addr, addr + len) of the current process resident and privately writable
+// so that the kernel can write into a user buffer without faulting
+int PrepareUserWrite(void *addr, int len);
+
+// makes every page of a NUL terminated user string resident
+int PrepareUserString(char *str);
+
+// makes a NULL terminated user argument vector and every string in it resident
+int PrepareUserArgv(char **argv);
+
+#endif
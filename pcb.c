@@ -6,30 +6,128 @@
 #include <pcb.h>
 #include <frame_manager.h>
 #include <pte_manager.h>
+#include <swap.h>
+#include <dedup.h>
+#include <scheduler.h>
+#include <queue.h>
 
-// add a child pid to a pcb
-void PCBAddChild(pcb_t* parent_pcb, int child_pid) {
-  if (parent_pcb->child_pids_size == parent_pcb->child_pids_count) {
-    int *child_pids_new = malloc(parent_pcb->child_pids_size * 2 * sizeof(int));
-    for (int i = 0; i < parent_pcb->child_pids_count; i++) {
-      child_pids_new[i] = parent_pcb->child_pids[i];
-    }
-    parent_pcb->child_pids_size *= 2;
-    free(parent_pcb->child_pids);
-    parent_pcb->child_pids = child_pids_new;
+// number of page tables and kernel stacks kept for reuse by processes created later
+#define PCB_POOL_SIZE 16
+
+// number of buckets in the pid table, a power of two
+#define PID_TABLE_SIZE 256
+#define PID_BUCKET(pid) ((unsigned int) (pid) & (PID_TABLE_SIZE - 1))
+
+// every pcb that has been created and not yet freed
+pcb_t *all_pcbs = NULL;
+
+// number of pcbs in all_pcbs
+int num_pcbs = 0;
+
+// every pcb in all_pcbs hashed by pid, chained through pid_next
+// pids are handed out in increasing order, so consecutive processes land in consecutive buckets
+pcb_t *pid_table[PID_TABLE_SIZE];
+
+// page tables of exited processes, every entry already zeroed by ClearAddressSpace
+pte_t *free_page_tables[PCB_POOL_SIZE];
+int num_free_page_tables = 0;
+
+// first frame of each contiguous kernel stack pair left by exited processes
+int free_kernel_stacks[PCB_POOL_SIZE];
+int num_free_kernel_stacks = 0;
+
+// takes a zeroed page table from the pool, or allocates a new one if the pool is empty
+pte_t *TakePageTable() {
+  if (num_free_page_tables > 0) {
+    num_free_page_tables--;
+    return free_page_tables[num_free_page_tables];
   }
-  parent_pcb->child_pids[parent_pcb->child_pids_count] = child_pid;
-  parent_pcb->child_pids_count += 1;
+  pte_t *pt = malloc(sizeof(pte_t) * MAX_PT_LEN);
+  if (pt == NULL) {
+    TracePrintf(1, "TakePageTable: failed to malloc pt \n");
+    return NULL;
+  }
+  bzero(pt, sizeof(pte_t) * MAX_PT_LEN);
+  return pt;
 }
 
-// check if a pcb has a child with the specified pid
-int PCBHasChild(pcb_t* parent_pcb, int child_pid) {
-  for (int i = 0; i < parent_pcb->child_pids_count; i++) {
-    if (parent_pcb->child_pids[i] == child_pid) {
-      return 1;
-    }
+// returns a page table emptied by ClearAddressSpace to the pool, or frees it if the pool is full
+void ReturnPageTable(pte_t *pt) {
+  if (num_free_page_tables < PCB_POOL_SIZE) {
+    free_page_tables[num_free_page_tables] = pt;
+    num_free_page_tables++;
+    return;
+  }
+  free(pt);
+}
+
+// takes a kernel stack frame pair from the pool, or allocates a new one if the pool is empty
+// returns the first frame of the pair
+int TakeKernelStack() {
+  if (num_free_kernel_stacks > 0) {
+    num_free_kernel_stacks--;
+    return free_kernel_stacks[num_free_kernel_stacks];
   }
-  return 0;
+  return AllocateFrames(1);
+}
+
+// returns the kernel stack frames of a pcb to the pool, or frees them if the pool is full
+void ReturnKernelStack(pcb_t *pcb) {
+  if (num_free_kernel_stacks < PCB_POOL_SIZE) {
+    free_kernel_stacks[num_free_kernel_stacks] = pcb->kernel_stack_pages[0].pfn;
+    num_free_kernel_stacks++;
+    pcb->kernel_stack_pages[0].valid = 0;
+    pcb->kernel_stack_pages[1].valid = 0;
+    return;
+  }
+  ClearPTE(&pcb->kernel_stack_pages[0]);
+  ClearPTE(&pcb->kernel_stack_pages[1]);
+}
+
+// makes a pcb a child of parent_pcb
+void PCBAddChild(pcb_t* parent_pcb, pcb_t *child_pcb) {
+  child_pcb->parent = parent_pcb;
+  child_pcb->sibling_prev = NULL;
+  child_pcb->sibling_next = parent_pcb->children;
+  if (parent_pcb->children != NULL) {
+    parent_pcb->children->sibling_prev = child_pcb;
+  }
+  parent_pcb->children = child_pcb;
+}
+
+// takes a pcb off the children list of its parent
+void PCBRemoveChild(pcb_t *child_pcb) {
+  pcb_t *parent_pcb = child_pcb->parent;
+  if (child_pcb->sibling_prev != NULL) {
+    child_pcb->sibling_prev->sibling_next = child_pcb->sibling_next;
+  } else {
+    parent_pcb->children = child_pcb->sibling_next;
+  }
+  if (child_pcb->sibling_next != NULL) {
+    child_pcb->sibling_next->sibling_prev = child_pcb->sibling_prev;
+  }
+  child_pcb->sibling_next = NULL;
+  child_pcb->sibling_prev = NULL;
+}
+
+// moves an exited pcb from the children of its parent to the parent's zombies
+// zombies are only ever taken from the front, so that list is singly linked
+void PCBAddZombie(pcb_t *child_pcb) {
+  pcb_t *parent_pcb = child_pcb->parent;
+  PCBRemoveChild(child_pcb);
+  child_pcb->zombie = 1;
+  child_pcb->sibling_next = parent_pcb->zombies;
+  parent_pcb->zombies = child_pcb;
+}
+
+// takes the most recently exited child of a pcb off its zombies, NULL if it has none
+pcb_t *PCBTakeZombie(pcb_t *parent_pcb) {
+  pcb_t *child_pcb = parent_pcb->zombies;
+  if (child_pcb != NULL) {
+    parent_pcb->zombies = child_pcb->sibling_next;
+    child_pcb->sibling_next = NULL;
+  }
+  return child_pcb;
 }
 
 // Create a new pcb for a user process
@@ -42,36 +140,126 @@ pcb_t* NewPCB()
   }
   bzero(pcb, sizeof(pcb_t));
 
-  // Create pcb kernel stack frames
-  int kernel_stack_frame_1 = AllocateFrame();
-  if (kernel_stack_frame_1 == -1) {
-    TracePrintf(1, "CreateRegion1PCB: failed to allocate kernel_stack_frame_1 \n");
+  // Create pcb kernel stack frames as one contiguous pair
+  int kernel_stack_frame = TakeKernelStack();
+  if (kernel_stack_frame == -1) {
+    TracePrintf(1, "CreateRegion1PCB: failed to allocate kernel stack frames \n");
+    free(pcb);
     return NULL;
   }
-  int kernel_stack_frame_2 = AllocateFrame();
-  if (kernel_stack_frame_2 == -1) {
-    TracePrintf(1, "CreateRegion1PCB: failed to allocate kernel_stack_frame_2 \n");
-    return NULL;
-  }
-  PopulatePTE(&pcb->kernel_stack_pages[0], PROT_READ | PROT_WRITE, kernel_stack_frame_1);
-  PopulatePTE(&pcb->kernel_stack_pages[1], PROT_READ | PROT_WRITE, kernel_stack_frame_2);
+  PopulatePTE(&pcb->kernel_stack_pages[0], PROT_READ | PROT_WRITE, kernel_stack_frame);
+  PopulatePTE(&pcb->kernel_stack_pages[1], PROT_READ | PROT_WRITE, kernel_stack_frame + 1);
 
   // Create pcb page table
-  pte_t *pt = malloc(sizeof(pte_t) * MAX_PT_LEN);
+  pte_t *pt = TakePageTable();
   if (pt == NULL) {
     TracePrintf(1, "CreateRegion1PCB: failed to malloc pt \n");
+    ReturnKernelStack(pcb);
+    free(pcb);
     return NULL;
   }
-  bzero(pt, sizeof(pte_t) * MAX_PT_LEN);
   pcb->pt_addr = pt;
 
   // Set pcb contents
   pcb->pid = helper_new_pid(pt);
-  pcb->parent_pid = -1;
-  pcb->delay_ticks = 0;
-  pcb->child_pids_size = 4;
-  pcb->child_pids_count = 0;
-  pcb->child_pids = malloc(pcb->child_pids_size * sizeof(int));
+  pcb->wake_tick = 0;
+  pcb->sched_tickets = SCHED_DEFAULT_TICKETS;
+
+  // Add pcb to the list of all pcbs
+  pcb->all_prev = NULL;
+  pcb->all_next = all_pcbs;
+  if (all_pcbs != NULL) {
+    all_pcbs->all_prev = pcb;
+  }
+  all_pcbs = pcb;
+  num_pcbs++;
+
+  // and to the pid table
+  pcb->pid_next = pid_table[PID_BUCKET(pcb->pid)];
+  pid_table[PID_BUCKET(pcb->pid)] = pcb;
 
   return pcb;
 }
+
+// releases every page mapped in region 1 of a pcb, along with any evicted copies of them, and drops its areas
+// only the pages inside its areas are visited, since no page outside them is ever mapped
+void ClearAddressSpace(pcb_t *pcb)
+{
+  DedupRemovePCB(pcb);
+  for (VMA_t *vma = pcb->vmas; vma != NULL; vma = vma->next) {
+    ForgetPages(pcb, vma->start, vma->end);
+    ClearPTERegion(pcb->pt_addr, vma->start, vma->end);
+  }
+  FreeVMAs(&pcb->vmas);
+}
+
+// frees a pcb whose region 1 has already been cleared, keeping its page table and kernel stack for reuse
+void FreePCB(pcb_t *pcb)
+{
+  SwapRemovePCB(pcb);
+  DedupRemovePCB(pcb);
+  removeFromQueue(pcb);
+  if (pcb->all_prev != NULL) {
+    pcb->all_prev->all_next = pcb->all_next;
+  } else {
+    all_pcbs = pcb->all_next;
+  }
+  if (pcb->all_next != NULL) {
+    pcb->all_next->all_prev = pcb->all_prev;
+  }
+  num_pcbs--;
+  for (pcb_t **p = &pid_table[PID_BUCKET(pcb->pid)]; *p != NULL; p = &(*p)->pid_next) {
+    if (*p == pcb) {
+      *p = pcb->pid_next;
+      break;
+    }
+  }
+
+  ReturnPageTable(pcb->pt_addr);
+  ReturnKernelStack(pcb);
+  free(pcb->profile);
+  free(pcb);
+}
+
+// number of frames mapped in region 1 of a pcb
+// only asked for by GetRusage, so it is counted then instead of on every map and unmap
+int PCBResidentFrames(pcb_t *pcb) {
+  pte_t *pt = pcb->pt_addr;
+  int frames = 0;
+  for (VMA_t *vma = pcb->vmas; vma != NULL; vma = vma->next) {
+    for (int page = vma->start; page < vma->end; page++) {
+      frames += pt[page].valid;
+    }
+  }
+  return frames;
+}
+
+// adds every counter of a Rusage to those of total
+void AddRusage(Rusage_t *total, Rusage_t *rusage) {
+  total->ticks += rusage->ticks;
+  total->voluntary_switches += rusage->voluntary_switches;
+  total->involuntary_switches += rusage->involuntary_switches;
+  total->page_faults += rusage->page_faults;
+  total->syscalls += rusage->syscalls;
+  for (int i = 0; i < RUSAGE_SYSCALLS; i++) {
+    total->syscalls_by_number[i] += rusage->syscalls_by_number[i];
+  }
+}
+
+// frees a zombie whose parent has collected it, or no longer can, and lets its pid be reused
+// the pid stays taken while the process is a zombie, so Wait never returns a pid that is in use again
+void ReapPCB(pcb_t *pcb)
+{
+  helper_retire_pid(pcb->pid);
+  FreePCB(pcb);
+}
+
+// returns the pcb of a process that has not been reaped yet, NULL if there is none with that pid
+pcb_t *FindPCB(int pid) {
+  for (pcb_t *pcb = pid_table[PID_BUCKET(pid)]; pcb != NULL; pcb = pcb->pid_next) {
+    if (pcb->pid == pid) {
+      return pcb;
+    }
+  }
+  return NULL;
+}
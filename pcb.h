@@ -7,6 +7,12 @@
 #define _pcb_h
 
 #include <ykernel.h>
+#include <text_cache.h>
+#include <vma.h>
+#include <custom_syscalls.h>
+
+struct Queue;
+struct Profile;
 
 struct pcb
 {
@@ -16,21 +22,78 @@ struct pcb
   void *pt_addr;          // address of the corresponding page table
   void *brk;              // user brk set by Brk syscall
   void *orig_brk;         // initial value of brk
+  void *user_sp;          // user stack pointer when the process last trapped into the kernel, which bounds stack growth
+  TextImage_t *text_image; // shared text of the program this process is running, NULL if none
+  VMA_t *vmas;            // areas making up region 1, sorted by start page
   int pid;                // process id generated by helper_new_pid()
-  int parent_pid;         // pid of the process's parent. If there is no such parent, then the value is -1
-  int delay_ticks;        // dont switch to this process while delay_ticks > 0, ticks down every clock trap
-  int *child_pids;        // pids of all children of this process created with Fork()
-  int child_pids_count;   // number of pids in child_pids array
-  int child_pids_size;    // size of child_pids array
+  struct pcb *parent;     // process that forked this one, init_pcb once that has exited, NULL for init and idle
+  struct pcb *children;   // children that have not exited, linked through sibling_next and sibling_prev
+  struct pcb *zombies;    // children that have exited and not yet been collected by Wait, linked through sibling_next
+  struct pcb *sibling_next; // neighbours in the parent's children or zombies list
+  struct pcb *sibling_prev;
+  int exit_status;        // status passed to Exit, kept until the parent collects it
+  int zombie;             // 1 once the process has exited, until its parent collects it
+  int waiting_for_child;  // 1 while the process is blocked in Wait
+  Rusage_t rusage;        // what the process has used so far, frames are only counted by GetRusage
+  Rusage_t child_rusage;  // sum of what its children collected with Wait used, including their collected children
+  Rusage_t waited_rusage; // what the child collected by its last Wait used
+  struct Profile *profile; // clock tick samples of the program the process runs, NULL until the first one, see profiler.h
+  unsigned int wake_tick; // clock tick a process sleeping in Delay wakes up on, 0 if it is not sleeping
+  struct pcb *timer_next; // next process in the same slot of the timing wheel
+  struct pcb *queue_next; // neighbours in the ready or wait queue the process is on, see queue.h
+  struct pcb *queue_prev;
+  struct Queue *queue;    // the queue the process is on, NULL if it is on none
+  int sched_level;        // level of the multilevel feedback queue the process is at, see mlfq.c
+  int sched_ticks;        // clock ticks the process has run in its current quantum, or at its current level under mlfq
+  int sched_quantum;      // clock ticks the process runs before it may be switched away from, 0 for the default
+  int sched_tickets;      // share of the cpu under the stride policy, see stride.c
+  long long sched_pass;   // virtual time the process has used under the stride policy, wide enough never to wrap
+  int sched_ready;        // 1 while the process is with the scheduling policy's ready processes
+  unsigned char page_state[MAX_PT_LEN]; // swap state of each region 1 page, see swap.h
+  struct pcb *pid_next;   // next pcb in the same bucket of the pid table
+  struct pcb *all_next;   // neighbours in all_pcbs
+  struct pcb *all_prev;
 };
 
 typedef struct pcb pcb_t;
 
-void PCBAddChild(pcb_t* parent_pcb, int child_pid);
+// every pcb that has been created and not yet freed
+extern pcb_t *all_pcbs;
+
+// number of pcbs in all_pcbs
+extern int num_pcbs;
+
+// makes a pcb a child of parent_pcb
+void PCBAddChild(pcb_t* parent_pcb, pcb_t *child_pcb);
 
-int PCBHasChild(pcb_t* parent_pcb, int child_pid);
+// takes a pcb off the children list of its parent
+void PCBRemoveChild(pcb_t *child_pcb);
+
+// moves an exited pcb from the children of its parent to the parent's zombies
+void PCBAddZombie(pcb_t *child_pcb);
+
+// takes the most recently exited child of a pcb off its zombies, NULL if it has none
+pcb_t *PCBTakeZombie(pcb_t *parent_pcb);
 
 pcb_t* NewPCB();
 
+// number of frames mapped in region 1 of a pcb
+int PCBResidentFrames(pcb_t *pcb);
+
+// adds every counter of a Rusage to those of total
+void AddRusage(Rusage_t *total, Rusage_t *rusage);
+
+// frees a zombie whose parent has collected it, or no longer can, and lets its pid be reused
+void ReapPCB(pcb_t *pcb);
+
+// returns the pcb of a process that has not been reaped yet, NULL if there is none with that pid
+pcb_t *FindPCB(int pid);
+
+// releases every page mapped in region 1 of a pcb, along with any evicted copies of them, and drops its areas
+void ClearAddressSpace(pcb_t *pcb);
+
+// frees a pcb whose region 1 has already been cleared, keeping its page table and kernel stack for reuse
+void FreePCB(pcb_t *pcb);
+
 
 #endif
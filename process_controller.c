@@ -8,108 +8,42 @@
 #include <kernel.h>
 #include <frame_manager.h>
 #include <pte_manager.h>
-
-// ExitNode Struct
-struct ExitNode {
-    int pid;
-    int status;
-};
-
-typedef struct ExitNode ExitNode_t;
+#include <process_controller.h>
+#include <scheduler.h>
+#include <timer_wheel.h>
 
 // global values for queues and other mechanisms
 // of storage for yalnix os
-ExitNode_t *exit_statuses;
-int exit_statuses_entries = 0;
-int exit_statuses_size = 4;
-Queue_t *ready_queue;
-Queue_t *child_wait_queue;
-Queue_t *delay_wait_queue;
 Queue_t *tty_read_queues[NUM_TERMINALS];
 pcb_t *tty_writers[NUM_TERMINALS];
-Queue_t *temp_queue;
+
+// context switches done by KCSwitch, how many of them changed the region 1 page table,
+// and how many TLB flushes they needed in total
+int num_context_switches = 0;
+int num_ptbr1_writes = 0;
+int num_switch_tlb_flushes = 0;
 
 // Creates all the global values 
 void InitQueues() {
-  exit_statuses = malloc(exit_statuses_size * sizeof(ExitNode_t));
-  ready_queue = createQueue();
-  child_wait_queue = createQueue();
-  delay_wait_queue = createQueue();
+  InitScheduler();
   for (int i = 0; i < NUM_TERMINALS; i++) {
     tty_read_queues[i] = createQueue();
   }
   bzero(tty_writers, sizeof(tty_writers));
-  temp_queue = createQueue();
-}
-
-// saves given exit status for given pid
-void SaveExitStatus(int pid, int status) {
-  // create new exit status
-  if (exit_statuses_entries == exit_statuses_size) {
-    ExitNode_t *exit_statuses_new = malloc(exit_statuses_size * 2 * sizeof(ExitNode_t));
-    for (int i = 0; i < exit_statuses_size; i++) {
-      exit_statuses_new[i] = exit_statuses[i];
-    }
-    exit_statuses_size *= 2;
-    free(exit_statuses);
-    exit_statuses = exit_statuses_new;
-  }
-  
-  // save on preexisting exit status entry
-  exit_statuses[exit_statuses_entries].pid = pid;
-  exit_statuses[exit_statuses_entries].status = status;
-  exit_statuses_entries += 1;
-}
-
-// Gets given exit status
-int GetExitStatus(int pid) {
-  for (int i = 0; i < exit_statuses_entries; i++) {
-    if (exit_statuses[i].pid == pid) {
-      return exit_statuses[i].status; 
-    };
-  }
-  return -1;
 }
 
-// tick the delay value of all pcbs in the delay queue
-// if the delay value of a pcb is 0, add it to the ready queue
+// advance the clock by one tick, and make every pcb whose Delay ends on it ready
 void TickDelayedPCBs() {
-  pcb_t *pcb = deQueue(delay_wait_queue);
-  while (pcb != NULL) {
-    if (pcb->delay_ticks > 0) {
-      pcb->delay_ticks -= 1;
-      enQueue(temp_queue, pcb);
-    } else {
-      enQueue(ready_queue, pcb);
-    }
-    pcb = deQueue(delay_wait_queue);
-  }
-
-  pcb = deQueue(temp_queue);
-  while (pcb != NULL) {
-    enQueue(delay_wait_queue, pcb);
-    pcb = deQueue(temp_queue);
-  }
+  TimerWheelTick(SchedEnqueue);
 }
 
-// check if any waiting parent was waiting for this child
-void TickChildWaitPCBs(int child_pid, int status) {
-  pcb_t *pcb = deQueue(child_wait_queue);
-  while (pcb != NULL) {
-    if (PCBHasChild(pcb, child_pid)) {
-      enQueue(ready_queue, pcb);
-      pcb->uc.regs[1] = status;
-      pcb->uc.regs[0] = child_pid;
-      break;
-    }
-    enQueue(temp_queue, pcb);
-    pcb = deQueue(child_wait_queue);
-  }
-
-  pcb = deQueue(temp_queue);
-  while (pcb != NULL) {
-    enQueue(child_wait_queue, pcb);
-    pcb = deQueue(temp_queue);
+// makes a process that has exited a zombie of its parent, and wakes the parent if it is blocked in Wait
+void NotifyParent(pcb_t *pcb) {
+  pcb_t *parent = pcb->parent;
+  PCBAddZombie(pcb);
+  if (parent->waiting_for_child) {
+    parent->waiting_for_child = 0;
+    SchedEnqueue(parent);
   }
 }
 
@@ -117,30 +51,27 @@ void TickChildWaitPCBs(int child_pid, int status) {
 void UnblockTtyReader(int tty_id) {
   pcb_t *pcb = deQueue(tty_read_queues[tty_id]);
   if (pcb != NULL) {
-    enQueue(ready_queue, pcb);
+    SchedWake(pcb);
+    SchedEnqueue(pcb);
   }
 }
 
 void AddPCB(pcb_t *pcb) {
-  if (pcb->delay_ticks > 0) {
-    enQueue(delay_wait_queue, pcb);
+  if (pcb->wake_tick > clock_ticks_now) {
+    TimerWheelAdd(pcb);
   } else {
-    enQueue(ready_queue, pcb);
+    SchedEnqueue(pcb);
   }
 }
 
 void AddPCBFront(pcb_t *pcb) {
-  if (pcb->delay_ticks > 0) {
-    enQueueFront(delay_wait_queue, pcb);
+  if (pcb->wake_tick > clock_ticks_now) {
+    TimerWheelAdd(pcb);
   } else {
-    enQueueFront(ready_queue, pcb);
+    SchedEnqueueFront(pcb);
   }
 }
 
-void AddChildWaitPCB(pcb_t *pcb) {
-  enQueue(child_wait_queue, pcb);
-}
-
 void BlockTtyReader(int tty_id, pcb_t *pcb) {
   enQueue(tty_read_queues[tty_id], pcb);
 }
@@ -168,7 +99,8 @@ int UnsetTtyWriter(int tty_id) {
 int UnblockTtyWriter(int tty_id) {
   pcb_t *pcb = tty_writers[tty_id];
   if (pcb != NULL) {
-    enQueue(ready_queue, pcb);
+    SchedWake(pcb);
+    SchedEnqueue(pcb);
     return 0;
   }
   return -1;
@@ -176,61 +108,23 @@ int UnblockTtyWriter(int tty_id) {
 
 KernelContext *KCCopy( KernelContext *kc_in, void *new_pcb_p, void *not_used){
   pcb_t *pcb = (pcb_t*) new_pcb_p;
-  
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-  
+
   // STEP 1: save proc A kernel context into new proc
   memcpy(&(pcb->kc), kc_in, sizeof(KernelContext));
 
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
   // STEP 2: copy kernel stack contents into new proc
-  // make red zone valid
-  void *red_zone_addr_1 = (void *) (KERNEL_STACK_BASE - (2 * PAGESIZE));
-  void *red_zone_addr_2 = (void *) (KERNEL_STACK_BASE - PAGESIZE);
-  int red_zone_page_1 = (int) red_zone_addr_1 >> PAGESHIFT;
-  int red_zone_page_2 = (int) red_zone_addr_2 >> PAGESHIFT;
-  int red_zone_frame_1 = AllocateFrame();
-  int red_zone_frame_2 = AllocateFrame();
-  PopulatePTE(&kernel_pt[red_zone_page_1], PROT_READ | PROT_WRITE, red_zone_frame_1);
-  PopulatePTE(&kernel_pt[red_zone_page_2], PROT_READ | PROT_WRITE, red_zone_frame_2);
-
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-  // copy current kernel stack frame contents into red zone
-  void *curr_kernel_stack_addr_1 = (void *) (KERNEL_STACK_BASE);
-  void *curr_kernel_stack_addr_2 = (void *) (KERNEL_STACK_BASE + PAGESIZE);
-  memcpy(red_zone_addr_1, curr_kernel_stack_addr_1, PAGESIZE);
-  memcpy(red_zone_addr_2, curr_kernel_stack_addr_2, PAGESIZE);
-
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-  // point current kernel stack pages at red zone frames
-  DeallocateFrame(pcb->kernel_stack_pages[0].pfn);
-  DeallocateFrame(pcb->kernel_stack_pages[1].pfn);
-  pcb->kernel_stack_pages[0].pfn = red_zone_frame_1;
-  pcb->kernel_stack_pages[1].pfn = red_zone_frame_2;
-
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-  // make red zone invalid
-  kernel_pt[red_zone_page_1].valid = 0;
-  kernel_pt[red_zone_page_2].valid = 0;
-  
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-  
+  // each of the new proc's kernel stack frames is mapped in the kmap window just long enough to copy into it,
+  // which only invalidates the kmap page itself, and the running kernel stack and region 1 are left alone
+  for (int i = 0; i < KERNEL_STACK_MAXSIZE >> PAGESHIFT; i++) {
+    void *stack_copy = KMap(pcb->kernel_stack_pages[i].pfn);
+    if (stack_copy == NULL) {
+      TracePrintf(1, "KCCopy: failed to map kernel stack page %d of pid %d\n", i, pcb->pid);
+      return kc_in;
+    }
+    memcpy(stack_copy, (void *) (KERNEL_STACK_BASE + i * PAGESIZE), PAGESIZE);
+    KUnmap(stack_copy);
+  }
+
   if (pcb->pid != idle_pcb->pid) {
     AddPCB(pcb);
   }
@@ -241,61 +135,70 @@ KernelContext *KCCopy( KernelContext *kc_in, void *new_pcb_p, void *not_used){
 KernelContext *KCSwitch( KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p) {
   pcb_t *c_pcb = (pcb_t*) curr_pcb_p;
   pcb_t *next_pcb = (pcb_t*) next_pcb_p;
+  int flushes = num_page_tlb_flushes + num_region_tlb_flushes;
 
   // STEP 1: save proc A kernel context
   memcpy(&(c_pcb->kc), kc_in, sizeof(KernelContext));
-  
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-  
-  // STEP 2: change kernel stack page table entries for B
-  // save current kernel stack pages to current pcb
-  c_pcb->kernel_stack_pages[0] = kernel_pt[KERNEL_STACK_BASE >> PAGESHIFT];
-  c_pcb->kernel_stack_pages[1] = kernel_pt[(KERNEL_STACK_BASE >> PAGESHIFT) + 1];
-  
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-  // set current kernel stack pages to next pcb
-  kernel_pt[KERNEL_STACK_BASE >> PAGESHIFT] = next_pcb->kernel_stack_pages[0];
-  kernel_pt[(KERNEL_STACK_BASE >> PAGESHIFT) + 1] = next_pcb->kernel_stack_pages[1];
 
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+  // STEP 2: change kernel stack page table entries for B
+  // only the kernel stack pages whose frame actually changes need to be invalidated, one address each
+  for (int i = 0; i < KERNEL_STACK_MAXSIZE >> PAGESHIFT; i++) {
+    int page = (KERNEL_STACK_BASE >> PAGESHIFT) + i;
+    c_pcb->kernel_stack_pages[i] = kernel_pt[page];
+    if (kernel_pt[page].pfn != next_pcb->kernel_stack_pages[i].pfn) {
+      kernel_pt[page] = next_pcb->kernel_stack_pages[i];
+      FlushTLB((unsigned int) (page << PAGESHIFT));
+    }
+  }
 
-  // Set region 1 page table to next pcb
-  WriteRegister(REG_PTBR1, (unsigned int) (next_pcb->pt_addr));
+  // Set region 1 page table to next pcb, flushing region 1 only when it is a different page table
+  if (next_pcb->pt_addr != c_pcb->pt_addr) {
+    WriteRegister(REG_PTBR1, (unsigned int) (next_pcb->pt_addr));
+    FlushTLB(TLB_FLUSH_1);
+    num_ptbr1_writes++;
+  }
 
   curr_pcb = next_pcb;
+  num_context_switches++;
+  num_switch_tlb_flushes += num_page_tlb_flushes + num_region_tlb_flushes - flushes;
 
   // STEP 3: return saved kernel context for B
   KernelContext *kcp = &(next_pcb->kc);
   return kcp;
 }
 
-// requeue == 0 -> Exit, TtyRead, TtyWrite, LockAcquire (don't requeue)
-// requeue == 1 -> Clock, Delay, LockRelease                         (requeue)
-// requeue == 2 -> Wait                    (wait queue)
+// prints how many context switches there were and how many TLB flushes they and the rest of the kernel needed
+void PrintSwitchStats() {
+  TracePrintf(0, "switch: %d context switches, %d page table changes, %d TLB flushes\n",
+              num_context_switches, num_ptbr1_writes, num_switch_tlb_flushes);
+  if (num_context_switches > 0) {
+    TracePrintf(0, "switch: %d.%02d TLB flushes per switch\n", num_switch_tlb_flushes / num_context_switches,
+                (num_switch_tlb_flushes * 100 / num_context_switches) % 100);
+  }
+  TracePrintf(0, "tlb: %d page flushes, %d region flushes\n", num_page_tlb_flushes, num_region_tlb_flushes);
+}
+
+// requeue == SWITCH_BLOCK      -> Exit, Wait, TtyRead, TtyWrite, LockAcquire (don't requeue)
+// requeue == SWITCH_REQUEUE    -> Clock, Delay, LockRelease                   (requeue)
 // ready_pcb_override == PCB  -> LockRelease
 // ready_pcb_override == NULL -> everything else
 void SwitchPCB(UserContext *uc, int requeue, pcb_t *ready_pcb_override) {
   // use the ready_pcb_override pcb
   pcb_t *ready_pcb = ready_pcb_override;
-  // otherwise use round-robin scheduling to context switch to the next process in the ready queue if it exists
+  // otherwise let the scheduling policy pick the next process
   if (ready_pcb == NULL) {
-    ready_pcb = deQueue(ready_queue);
+    ready_pcb = SchedDequeue();
   }
 
-  if (ready_pcb == NULL && requeue == 1) {
+  // a process that is going to sleep in Delay can't keep running, even when nothing else is ready
+  int sleeping = curr_pcb->wake_tick > clock_ticks_now;
+  if (ready_pcb == NULL && requeue == SWITCH_REQUEUE && !sleeping) {
     TracePrintf(1,"SwitchPCB: No ready PCBs and requeuing, continue current process\n");
     return;
   }
 
-  if (ready_pcb == NULL && requeue != 1) {
-    TracePrintf(1,"SwitchPCB: No ready PCBs and not requeuing, dispatch idle process\n");
+  if (ready_pcb == NULL) {
+    TracePrintf(1,"SwitchPCB: No ready PCBs and not requeuing or sleeping, dispatch idle process\n");
     ready_pcb = idle_pcb;
   } else {
     TracePrintf(1,"SwitchPCB: Found a ready PCB\n");
@@ -304,14 +207,21 @@ void SwitchPCB(UserContext *uc, int requeue, pcb_t *ready_pcb_override) {
   // On the way into a handler (Transition 5), copy the current UserContext into the PCB of the current process
   curr_pcb->uc = *uc;
 
-  // requeue, but only if not idle
-  if (requeue == 1 && curr_pcb->pid != idle_pcb->pid) {
-    AddPCB(curr_pcb);
+  // a process that could have kept running was switched away from against its will
+  if (requeue == SWITCH_REQUEUE && !sleeping) {
+    curr_pcb->rusage.involuntary_switches++;
+  } else {
+    curr_pcb->rusage.voluntary_switches++;
   }
 
-  // add to child wait queue
-  if (requeue == 2) {
-    AddChildWaitPCB(curr_pcb);
+  // a process that is not requeued, or is going to sleep, is blocking
+  if ((requeue != SWITCH_REQUEUE || sleeping) && curr_pcb != idle_pcb) {
+    SchedBlock(curr_pcb);
+  }
+
+  // requeue, but only if not idle
+  if (requeue == SWITCH_REQUEUE && curr_pcb->pid != idle_pcb->pid) {
+    AddPCB(curr_pcb);
   }
 
   // Invoke your KCSwitch() function (Transitions 8 and 9) to change from the old process to the next process.
@@ -320,13 +230,7 @@ void SwitchPCB(UserContext *uc, int requeue, pcb_t *ready_pcb_override) {
     return;
   }
 
-  // Flush the TLB
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_0);
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-
-  // Set region 1 page table to next pcb
-  WriteRegister(REG_PTBR1, (unsigned int) (curr_pcb->pt_addr));
-  
+  // KCSwitch already pointed region 1 at the page table of curr_pcb and flushed what changed
 
   // copy the UserContext from the current PCB back to the uctxt address passed to the handler (so that we go back to the right place)
   *uc = curr_pcb->uc;
@@ -21,15 +21,11 @@
 
 void InitQueues();
 
-void SaveExitStatus(int pid, int status);
-int GetExitStatus(int pid);
-
-// tick the delay value of all pcbs in the delay queue
-// if the delay value of a pcb is 0, add it to the ready queue
+// advance the clock by one tick, and make every pcb whose Delay ends on it ready
 void TickDelayedPCBs();
 
-// check if any waiting parent was waiting for this child
-void TickChildWaitPCBs(int child_pid, int status);
+// makes a process that has exited a zombie of its parent, and wakes the parent if it is blocked in Wait
+void NotifyParent(pcb_t *pcb);
 
 // move one pcb from the tty read queue to the ready queue
 void UnblockTtyReader(int tty_id);
@@ -41,8 +37,6 @@ void AddPCB(pcb_t *pcb);
 
 void AddPCBFront(pcb_t *pcb);
 
-void AddChildWaitPCB(pcb_t *pcb);
-
 void BlockTtyReader(int tty_id, pcb_t *pcb);
 
 int SetTtyWriter(int tty_id, pcb_t *pcb);
@@ -52,6 +46,13 @@ KernelContext *KCCopy( KernelContext *kc_in, void *new_pcb_p, void *not_used);
 
 KernelContext *KCSwitch( KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p);
 
+// what SwitchPCB does with the process it switches away from
+#define SWITCH_BLOCK 0        // nothing, it is already waiting somewhere, waiting for a child, or is exiting
+#define SWITCH_REQUEUE 1      // puts it back with the ready processes, or the delayed ones if it is delaying
+
 void SwitchPCB(UserContext *uc, int requeue, pcb_t *ready_pcb_override);
 
+// prints how many context switches there were and how many TLB flushes they and the rest of the kernel needed
+void PrintSwitchStats();
+
 #endif
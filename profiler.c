@@ -0,0 +1,240 @@
+// Contains the clock tick sampling profiler for user programs
+//
+// Andrew Chen
+// 10/2026
+
+#include <libelf.h>
+#include <gelf.h>
+#include <ykernel.h>
+#include <kernel.h>
+#include <page_fault.h>
+#include <text_cache.h>
+#include <profiler.h>
+
+// 1 to sample every process on each clock tick and print its profile when it exits or execs
+int profile_enabled = 0;
+
+// caller frames to walk for each sample by following the saved frame pointers
+int profile_depth = 0;
+
+// samples of one function, as printed by DumpProfile
+struct ProfileLine {
+  char *name;
+  int self;
+  int total;
+};
+
+typedef struct ProfileLine ProfileLine_t;
+
+// returns the bucket holding pc in a profile, taking a free one if pc has none yet
+// returns NULL if every bucket holds another pc
+struct ProfileEntry *ProfileEntry(Profile_t *profile, unsigned int pc) {
+  unsigned int bucket = (pc >> 2) * 2654435761u;
+  for (int i = 0; i < PROFILE_BUCKETS; i++) {
+    struct ProfileEntry *entry = &profile->entries[(bucket + i) & (PROFILE_BUCKETS - 1)];
+    if (entry->pc == pc) {
+      return entry;
+    }
+    if (entry->pc == 0) {
+      entry->pc = pc;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// returns 1 if the aligned word at addr is mapped readable in region 1 of the current process
+// the clock may interrupt a process whose frame pointer points anywhere, so nothing is read without checking
+int UserWordReadable(unsigned int addr) {
+  if (addr < VMEM_1_BASE || addr > VMEM_1_LIMIT - sizeof(unsigned int) || (addr & (sizeof(unsigned int) - 1)) != 0) {
+    return 0;
+  }
+  pte_t *pte = &((pte_t *) curr_pcb->pt_addr)[REGION_1_PAGE(addr)];
+  return pte->valid && (pte->prot & PROT_READ);
+}
+
+// records the user pc the clock interrupted the running process at, and the return addresses of its callers
+// each frame holds the caller's frame pointer followed by the return address into the caller
+void ProfileTick(pcb_t *pcb, UserContext *uc) {
+  unsigned int pc = (unsigned int) uc->pc;
+  if (!profile_enabled || pcb == idle_pcb || pc < VMEM_1_BASE || pc >= VMEM_1_LIMIT) {
+    return;
+  }
+  if (pcb->profile == NULL) {
+    pcb->profile = malloc(sizeof(Profile_t));
+    if (pcb->profile == NULL) {
+      TracePrintf(1, "ProfileTick: failed to malloc profile for pid %d\n", pcb->pid);
+      return;
+    }
+    bzero(pcb->profile, sizeof(Profile_t));
+  }
+  Profile_t *profile = pcb->profile;
+
+  profile->samples++;
+  struct ProfileEntry *entry = ProfileEntry(profile, pc);
+  if (entry == NULL) {
+    profile->dropped++;
+    return;
+  }
+  entry->self++;
+  entry->total++;
+
+  unsigned int fp = (unsigned int) uc->ebp;
+  for (int depth = 0; depth < profile_depth && depth < PROFILE_MAX_DEPTH; depth++) {
+    if (!UserWordReadable(fp) || !UserWordReadable(fp + sizeof(unsigned int))) {
+      break;
+    }
+    unsigned int caller_fp = *(unsigned int *) fp;
+    unsigned int ret = *(unsigned int *) (fp + sizeof(unsigned int));
+    if ((entry = ProfileEntry(profile, ret)) != NULL) {
+      entry->total++;
+    }
+    // frames only get older further up the stack, which also stops a corrupt chain from looping
+    if (caller_fp <= fp) {
+      break;
+    }
+    fp = caller_fp;
+  }
+}
+
+// orders symbols by address
+int CompareSymbols(const void *a, const void *b) {
+  unsigned int addr_a = ((Symbol_t *) a)->addr;
+  unsigned int addr_b = ((Symbol_t *) b)->addr;
+  return addr_a < addr_b ? -1 : addr_a > addr_b;
+}
+
+// reads the functions in the symbol table of an executable into its text image, sorted by address
+// the file is the one LoadProgram opened, and is only read the first time a profile of the program is printed
+void LoadSymbols(TextImage_t *image) {
+  if (image->num_symbols != -1) {
+    return;
+  }
+  image->num_symbols = 0;
+  if (elf_version(EV_CURRENT) == EV_NONE) {
+    TracePrintf(1, "LoadSymbols: libelf is out of date\n");
+    return;
+  }
+  Elf *elf = elf_begin(image->fd, ELF_C_READ, NULL);
+  if (elf == NULL) {
+    TracePrintf(1, "LoadSymbols: can't read '%s' as elf\n", image->name);
+    return;
+  }
+
+  Elf_Scn *scn = NULL;
+  GElf_Shdr shdr;
+  while ((scn = elf_nextscn(elf, scn)) != NULL) {
+    if (gelf_getshdr(scn, &shdr) == NULL || shdr.sh_type != SHT_SYMTAB || shdr.sh_entsize == 0) {
+      continue;
+    }
+    Elf_Data *data = elf_getdata(scn, NULL);
+    int count = shdr.sh_size / shdr.sh_entsize;
+    image->symbols = malloc(count * sizeof(Symbol_t));
+    if (data == NULL || image->symbols == NULL) {
+      TracePrintf(1, "LoadSymbols: failed to read the symbols of '%s'\n", image->name);
+      break;
+    }
+    for (int i = 0; i < count; i++) {
+      GElf_Sym sym;
+      if (gelf_getsym(data, i, &sym) == NULL || GELF_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_value == 0) {
+        continue;
+      }
+      char *name = elf_strptr(elf, shdr.sh_link, sym.st_name);
+      Symbol_t *symbol = &image->symbols[image->num_symbols];
+      symbol->name = malloc(strlen(name != NULL ? name : "?") + 1);
+      if (symbol->name == NULL) {
+        continue;
+      }
+      strcpy(symbol->name, name != NULL ? name : "?");
+      symbol->addr = sym.st_value;
+      symbol->size = sym.st_size;
+      image->num_symbols++;
+    }
+    break;
+  }
+  elf_end(elf);
+  qsort(image->symbols, image->num_symbols, sizeof(Symbol_t), CompareSymbols);
+  TracePrintf(1, "LoadSymbols: %d functions in '%s'\n", image->num_symbols, image->name);
+}
+
+// returns the index of the function of an executable containing pc, -1 if it is in none of them
+int FindSymbol(TextImage_t *image, unsigned int pc) {
+  int lo = 0;
+  int hi = image->num_symbols - 1;
+  int found = -1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    if (image->symbols[mid].addr <= pc) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  if (found == -1 || pc >= image->symbols[found].addr + image->symbols[found].size) {
+    return -1;
+  }
+  return found;
+}
+
+// orders the lines of a profile by self samples, then total samples, most first
+int CompareProfileLines(const void *a, const void *b) {
+  ProfileLine_t *line_a = (ProfileLine_t *) a;
+  ProfileLine_t *line_b = (ProfileLine_t *) b;
+  if (line_a->self != line_b->self) {
+    return line_b->self - line_a->self;
+  }
+  return line_b->total - line_a->total;
+}
+
+// prints the samples of a process by function, resolved against the symbols of the executable it runs, and drops them
+// samples at pcs outside every known function are summed up as "?"
+void DumpProfile(pcb_t *pcb) {
+  Profile_t *profile = pcb->profile;
+  if (profile == NULL) {
+    return;
+  }
+  pcb->profile = NULL;
+  TextImage_t *image = pcb->text_image;
+  int num_symbols = 0;
+  if (image != NULL) {
+    LoadSymbols(image);
+    num_symbols = image->num_symbols;
+  }
+
+  // one line per function, and a last one for everything else
+  ProfileLine_t *lines = malloc((num_symbols + 1) * sizeof(ProfileLine_t));
+  if (lines == NULL) {
+    TracePrintf(1, "DumpProfile: failed to malloc lines for pid %d\n", pcb->pid);
+    free(profile);
+    return;
+  }
+  for (int i = 0; i < num_symbols; i++) {
+    lines[i].name = image->symbols[i].name;
+    lines[i].self = 0;
+    lines[i].total = 0;
+  }
+  lines[num_symbols].name = "?";
+  lines[num_symbols].self = 0;
+  lines[num_symbols].total = 0;
+  for (int i = 0; i < PROFILE_BUCKETS; i++) {
+    struct ProfileEntry *entry = &profile->entries[i];
+    if (entry->pc == 0) {
+      continue;
+    }
+    int symbol = image != NULL ? FindSymbol(image, entry->pc) : -1;
+    ProfileLine_t *line = &lines[symbol == -1 ? num_symbols : symbol];
+    line->self += entry->self;
+    line->total += entry->total;
+  }
+  qsort(lines, num_symbols + 1, sizeof(ProfileLine_t), CompareProfileLines);
+
+  TracePrintf(0, "profile: pid %d running %s, %d samples, %d dropped\n", pcb->pid,
+              image != NULL ? image->name : "?", profile->samples, profile->dropped);
+  TracePrintf(0, "profile: %6s %6s  %s\n", "self", "total", "function");
+  for (int i = 0; i <= num_symbols && (lines[i].self > 0 || lines[i].total > 0); i++) {
+    TracePrintf(0, "profile: %6d %6d  %s\n", lines[i].self, lines[i].total, lines[i].name);
+  }
+  free(lines);
+  free(profile);
+}
@@ -0,0 +1,48 @@
+// Contains the clock tick sampling profiler for user programs
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _profiler_h
+#define _profiler_h
+
+#include <ykernel.h>
+#include <pcb.h>
+
+// number of distinct pcs a process's profile can hold, a power of two
+// samples at further pcs are counted as dropped
+#define PROFILE_BUCKETS 512
+
+// most caller frames walked for each sample, whatever profile_depth is set to
+#define PROFILE_MAX_DEPTH 8
+
+// samples taken at one pc
+// self counts the ticks that interrupted the program at pc, and total adds those where pc was a return address on the stack
+struct ProfileEntry {
+  unsigned int pc;        // 0 for an unused bucket
+  int self;
+  int total;
+};
+
+// histogram of the pcs a process was interrupted at since it loaded its program
+struct Profile {
+  int samples;
+  int dropped;
+  struct ProfileEntry entries[PROFILE_BUCKETS];
+};
+
+typedef struct Profile Profile_t;
+
+// 1 to sample every process on each clock tick and print its profile when it exits or execs, set with the profile boot option
+extern int profile_enabled;
+
+// caller frames to walk for each sample by following the saved frame pointers, set with the profile_depth boot option
+extern int profile_depth;
+
+// records the user pc the clock interrupted the running process at, and the return addresses of its callers
+void ProfileTick(pcb_t *pcb, UserContext *uc);
+
+// prints the samples of a process by function, resolved against the symbols of the executable it runs, and drops them
+void DumpProfile(pcb_t *pcb);
+
+#endif
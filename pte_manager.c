@@ -4,28 +4,26 @@
 // 2/2024
 
 #include <ykernel.h>
+#include <kernel.h>
 #include <frame_manager.h>
+#include <pte_manager.h>
 
-// create a new PTE with the specified prot and allocates a pfn
-// for use with user page tables
-pte_t* CreateUserPTE(int prot) {
-  pte_t* pte = malloc(sizeof(pte_t));
-  if (pte == NULL) {
-    TracePrintf(1, "CreateUserPTE: failed to malloc pte\n");
-    return NULL;
-  }
-  bzero(pte, sizeof(pte_t));
+// number of TLB flushes of a single page, and of a whole region or the whole TLB, since boot
+int num_page_tlb_flushes = 0;
+int num_region_tlb_flushes = 0;
 
-  int pfn = AllocateFrame();
-  if (pfn == -1) {
-    TracePrintf(1, "CreateUserPTE: failed to allocate pfn \n");
-    return NULL;
-  }
+// number of frames mapped into the kmap window since boot
+int num_kmaps = 0;
 
-  pte->valid = 1;
-  pte->prot = prot;
-  pte->pfn = pfn;
-  return pte;
+// invalidates the TLB entry for one page, or a whole region when given TLB_FLUSH_0, TLB_FLUSH_1 or TLB_FLUSH_ALL
+void FlushTLB(unsigned int target) {
+  WriteRegister(REG_TLB_FLUSH, target);
+  if (target == (unsigned int) TLB_FLUSH_0 || target == (unsigned int) TLB_FLUSH_1 ||
+      target == (unsigned int) TLB_FLUSH_ALL) {
+    num_region_tlb_flushes++;
+  } else {
+    num_page_tlb_flushes++;
+  }
 }
 
 // populates an existing PTE with the specified data
@@ -40,57 +38,76 @@ int PopulatePTE(pte_t* pte, int prot, int pfn) {
   return 0;
 }
 
-// makes an existing pte invalid, sets prot to 0, and frees the corresponding pfn
+// makes an existing pte invalid, zeroes it, and frees the corresponding pfn
+// a page table cleared entirely this way is all zero again and can be reused as is
 int ClearPTE(pte_t* pte) {
   if (pte->valid == 0) {
     return 0;
   }
-  if (DeallocateFrame(pte->pfn) == -1) {
+  if (ReleaseFrame(pte->pfn) == -1) {
     TracePrintf(1, "ClearKernelPTE: failed to deallocate pfn\n");
     return -1;
   }
   pte->prot = 0;
+  pte->pfn = 0;
   pte->valid = 0;
   return 0;
 }
 
-// frees an existing pte and frees the corresponding pfn
-// for use with user page tables
-int FreeUserPTE(pte_t* pte) {
-  if (DeallocateFrame(pte->pfn) == -1) {
-    TracePrintf(1, "FreeUserPTE: failed to deallocate pfn\n");
-    return -1;
+// allocates a zeroed frame for each page in [start_page, end_page) and fills in the page table entries in place
+// on failure every page mapped by this call is released again, leaving the range invalid
+int PopulatePTERegion(pte_t* pt, int start_page, int end_page, int prot) {
+  for (int page = start_page; page < end_page; page++)
+  {
+    int pfn = AllocateZeroedFrame();
+    if (pfn == -1 || PopulatePTE(&pt[page], prot, pfn) == -1) {
+      TracePrintf(1, "PopulatePTERegion: failed to map page number %d\n", page);
+      if (pfn != -1) {
+        DeallocateFrame(pfn);
+      }
+      ClearPTERegion(pt, start_page, page);
+      return -1;
+    }
   }
-  pte->valid = 0;
-  free(pte);
   return 0;
 }
 
-// creates multiple new PTE with the specified prot, allocates pfn for each, and enters them into a page table between the specified pages
-// for use with user page tables
-int PopulatePTERegion(pte_t* pt, int start_page, int end_page, int prot) {
-  for (int page = start_page; page < end_page; page++)
-  {
-    pte_t* pte = CreateUserPTE(prot);
-    if (pte == NULL) {
-      TracePrintf(1, "CreateUserPTERegion: failed create PTE for page number %d\n", page);
+// makes every valid PTE in [start_page, end_page) invalid and releases its frame
+// the caller is responsible for flushing the TLB
+int ClearPTERegion(pte_t* pt, int start_page, int end_page) {
+  for (int page = start_page; page < end_page; page++) {
+    if (ClearPTE(&pt[page]) == -1) {
+      TracePrintf(1, "ClearPTERegion: failed to clear PTE at page number %d\n", page);
       return -1;
     }
-    pt[page] = *pte;
   }
   return 0;
 }
 
 // Clears the PTE given
 int ClearPT(pte_t* pt) {
-  for (int page = 0; page < MAX_PT_LEN; page++) {
-    pte_t* pte = &pt[page];
-    if (pte->valid == 1) {
-      if (ClearPTE(pte) == -1) {
-        TracePrintf(1, "ClearPT: failed to clear PTE at page number %d\n", page);
-        return -1;
-      }
+  return ClearPTERegion(pt, 0, MAX_PT_LEN);
+}
+
+// maps a frame at a free page of the kmap window and returns the address it can be accessed at
+// the frame stays allocated to whoever owns it, and only the window page is invalidated in the TLB
+void *KMap(int pfn) {
+  for (int page = KMAP_BASE_PAGE; page < KMAP_BASE_PAGE + KMAP_SLOTS; page++) {
+    if (kernel_pt[page].valid == 0) {
+      PopulatePTE(&kernel_pt[page], PROT_READ | PROT_WRITE, pfn);
+      FlushTLB((unsigned int) (page << PAGESHIFT));
+      num_kmaps++;
+      return (void *) (page << PAGESHIFT);
     }
   }
-  return 0;
+  TracePrintf(1, "KMap: all %d kmap slots are in use\n", KMAP_SLOTS);
+  return NULL;
+}
+
+// unmaps a page of the kmap window returned by KMap without freeing the frame behind it
+void KUnmap(void *addr) {
+  int page = (unsigned int) addr >> PAGESHIFT;
+  kernel_pt[page].valid = 0;
+  kernel_pt[page].pfn = 0;
+  FlushTLB((unsigned int) addr);
 }
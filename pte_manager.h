@@ -5,19 +5,45 @@
 
 #include <ykernel.h>
 
+// number of TLB flushes of a single page, and of a whole region or the whole TLB, since boot
+extern int num_page_tlb_flushes;
+extern int num_region_tlb_flushes;
+
+// invalidates the TLB entry for one page, or a whole region when given TLB_FLUSH_0, TLB_FLUSH_1 or TLB_FLUSH_ALL
+// every flush goes through here so that they can be counted
+void FlushTLB(unsigned int target);
+
 // populates an existing PTE with the specified data
 int PopulatePTE(pte_t* pte, int prot, int pfn);
 
-// makes an existing pte invalid, sets prot to 0, and frees the corresponding pfn
+// makes an existing pte invalid, zeroes it, and frees the corresponding pfn
 int ClearPTE(pte_t* pte);
 
-// creates multiple new PTE with the specified prot, allocates pfn for each, and enters them into a page table between the specified pages
-// for use with user page tables
+// allocates a zeroed frame for each page in [start_page, end_page) and fills in the page table entries in place
+// on failure every page mapped by this call is released again, leaving the range invalid
 int PopulatePTERegion(pte_t* pt, int start_page, int end_page, int prot);
 
+// makes every valid PTE in [start_page, end_page) invalid and releases its frame
+// the caller is responsible for flushing the TLB
+int ClearPTERegion(pte_t* pt, int start_page, int end_page);
+
+// makes every valid PTE in a page table invalid and releases its frame
+int ClearPT(pte_t* pt);
 
-pte_t* CreateUserPTE(int prot);
+// region 0 pages, below the red zone under the kernel stack, that the kernel maps frames at while it reads or
+// writes a frame that is not otherwise mapped, such as a frame of another process or one that is being zeroed
+// a slot is taken by KMap and given back by KUnmap, so mappings may nest up to KMAP_SLOTS deep
+#define KMAP_SLOTS 4
+#define RED_ZONE_PAGES 2
+#define KMAP_BASE_PAGE ((KERNEL_STACK_BASE >> PAGESHIFT) - RED_ZONE_PAGES - KMAP_SLOTS)
+#define KMAP_BASE (KMAP_BASE_PAGE << PAGESHIFT)
 
-int FreeUserPTE(pte_t* pte);
+// number of frames mapped into the kmap window since boot
+extern int num_kmaps;
 
-int ClearPT(pte_t* pt);
+// maps a frame at a free page of the kmap window and returns the address it can be accessed at
+// returns NULL if every slot is in use
+void *KMap(int pfn);
+
+// unmaps a page of the kmap window returned by KMap without freeing the frame behind it
+void KUnmap(void *addr);
@@ -5,93 +5,94 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <ykernel.h>
 #include <pcb.h>
+#include <queue.h>
 
-//linkedlist node
-struct QNode {
-    pcb_t *pcb;
-    struct QNode* next;
-};
- 
-// The queue, front stores the front node of LL 
-// rear stores the last node of LL
-struct Queue {
-    struct QNode *front, *rear;
-};
-
-
-typedef struct Queue Queue_t;
-
-//create a new node
-struct QNode* newNode(pcb_t *pcb)
-{
-    struct QNode* temp = (struct QNode*)malloc(sizeof(struct QNode));
-    temp->pcb = pcb;
-    temp->next = NULL;
-    return temp;
-}
- 
 // create an empty queue
 struct Queue* createQueue()
 {
     struct Queue* q = (struct Queue*)malloc(sizeof(struct Queue));
+    if (q == NULL) {
+        return NULL;
+    }
     q->front = q->rear = NULL;
+    q->len = 0;
     return q;
 }
- 
-//add element to the end of queue
-void enQueue(struct Queue* q, pcb_t *pcb){
-    struct QNode* temp = newNode(pcb);
-    if (q->rear == NULL) {
-        q->front = q->rear = temp;
-        return;
-    } else {
-        q->rear->next = temp;
-        q->rear = temp;
+
+// add element right after prev, which is on the queue, or at the front if prev is NULL
+int enQueueAfter(struct Queue* q, pcb_t *prev, pcb_t *pcb)
+{
+    // a pcb still on a queue would corrupt both lists, and is a double enqueue by the caller
+    if (pcb->queue != NULL) {
+        TracePrintf(0, "enQueue: pid %d is already on a queue, not adding it again\n", pcb->pid);
+        return -1;
     }
 
+    pcb->queue_prev = prev;
+    pcb->queue_next = (prev == NULL) ? q->front : prev->queue_next;
+    if (pcb->queue_prev != NULL) {
+        pcb->queue_prev->queue_next = pcb;
+    } else {
+        q->front = pcb;
+    }
+    if (pcb->queue_next != NULL) {
+        pcb->queue_next->queue_prev = pcb;
+    } else {
+        q->rear = pcb;
+    }
+    pcb->queue = q;
+    q->len++;
+    return 0;
+}
+ 
+//add element to the end of queue
+int enQueue(struct Queue* q, pcb_t *pcb){
+    return enQueueAfter(q, q->rear, pcb);
 }
-
 
 //add element to the front of queue
-void enQueueFront(struct Queue* q, pcb_t *pcb) {
-    struct QNode* temp = newNode(pcb);
-    if (q->rear == NULL) {
-        q->front = q->rear = temp;
+int enQueueFront(struct Queue* q, pcb_t *pcb) {
+    return enQueueAfter(q, NULL, pcb);
+}
+
+// take an element out of whichever queue it is on, wherever it is in that queue
+void removeFromQueue(pcb_t *pcb)
+{
+    struct Queue* q = pcb->queue;
+    if (q == NULL) {
         return;
+    }
+    if (pcb->queue_prev != NULL) {
+        pcb->queue_prev->queue_next = pcb->queue_next;
     } else {
-        temp->next = q->front;
-        q->front = temp;
+        q->front = pcb->queue_next;
     }
+    if (pcb->queue_next != NULL) {
+        pcb->queue_next->queue_prev = pcb->queue_prev;
+    } else {
+        q->rear = pcb->queue_prev;
+    }
+    pcb->queue_next = pcb->queue_prev = NULL;
+    pcb->queue = NULL;
+    q->len--;
 }
 
 // pop an element from the front of the queue
 pcb_t *deQueue(struct Queue* q)
 {
-    // If queue is empty, return -1.
-    if (q->front == NULL)
-        return NULL;
- 
-    // Store previous front and move front one node ahead
-    struct QNode* temp = q->front;
- 
-    q->front = q->front->next;
- 
-    // If front becomes NULL, then change rear also as NULL
-    if (q->front == NULL)
-        q->rear = NULL;
-
-    pcb_t *i = temp->pcb;
-    free(temp);
-    return i;
+    // If queue is empty, return NULL.
+    pcb_t *pcb = q->front;
+    if (pcb != NULL) {
+        removeFromQueue(pcb);
+    }
+    return pcb;
 }
 
-// free a queue and its nodes, but not its contents
+// free a queue, taking every element off it first so none is left pointing at it
 void freeQueue(struct Queue* q) {
-    while (q->front != NULL) {
-        struct QNode *next = q->front->next;
-        free(q->front);
-        q->front = next;
+    while (deQueue(q) != NULL) {
     }
     free(q);
 }
@@ -10,34 +10,38 @@
 #include <stdlib.h>
 #include <pcb.h>
 
-struct QNode {
-    pcb_t *pcb;
-    struct QNode* next;
-};
- 
-
+// The queue is linked through queue_next and queue_prev in each pcb, so adding and removing a pcb never allocates
+// front stores the first pcb, rear stores the last pcb
+// a pcb is on at most one queue at a time, the one its queue field points at
 struct Queue {
-    struct QNode *front, *rear;
+    pcb_t *front, *rear;
+    int len;
 };
 
 typedef struct Queue Queue_t;
 
-//create a new node
-struct QNode* newNode(pcb_t *pcb);
- 
 // create an empty queue
 struct Queue* createQueue();
  
+// the enQueue functions return -1 without touching any queue if pcb is already on one,
+// since a process waiting in two places at once is a bug in the caller
+
 //add element to the end of queue
-void enQueue(struct Queue* q, pcb_t *pcb);
+int enQueue(struct Queue* q, pcb_t *pcb);
 
 //add element to the front of queue
-void enQueueFront(struct Queue* q, pcb_t *pcb);
+int enQueueFront(struct Queue* q, pcb_t *pcb);
+
+// add element right after prev, which is on the queue, or at the front if prev is NULL
+int enQueueAfter(struct Queue* q, pcb_t *prev, pcb_t *pcb);
 
 // pop an element from the front of the queue
 pcb_t *deQueue(struct Queue* q);
 
-// free a queue and its nodes, but not its contents
+// take an element out of whichever queue it is on, wherever it is in that queue
+void removeFromQueue(pcb_t *pcb);
+
+// free a queue, taking every element off it first so none is left pointing at it
 void freeQueue(struct Queue* q);
 
 #endif
@@ -0,0 +1,57 @@
+// Contains the round-robin scheduling policy, which runs every ready process for its quantum in turn
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <kernel.h>
+#include <queue.h>
+#include <scheduler.h>
+
+// ready processes in the order they will run
+Queue_t *rr_queue;
+
+// creates the empty queue of ready processes
+void RRInit() {
+  rr_queue = createQueue();
+}
+
+// adds a ready process behind every other one
+int RREnqueue(pcb_t *pcb) {
+  return enQueue(rr_queue, pcb);
+}
+
+// adds a ready process ahead of every other one
+int RREnqueueFront(pcb_t *pcb) {
+  return enQueueFront(rr_queue, pcb);
+}
+
+// removes and returns the process that has waited longest, which starts a fresh quantum
+pcb_t *RRDequeue() {
+  pcb_t *pcb = deQueue(rr_queue);
+  if (pcb != NULL) {
+    pcb->sched_ticks = 0;
+  }
+  return pcb;
+}
+
+// a process gives up the cpu once it has run for its quantum
+int RRTick(pcb_t *pcb) {
+  if (pcb == idle_pcb) {
+    return 1;
+  }
+  pcb->sched_ticks++;
+  return pcb->sched_ticks >= SchedQuantum(pcb);
+}
+
+SchedOps_t rr_sched_ops = {
+  "rr",
+  RRInit,
+  RREnqueue,
+  RREnqueueFront,
+  RRDequeue,
+  RRTick,
+  NULL,
+  NULL,
+  NULL
+};
@@ -0,0 +1,105 @@
+// Contains the interface every scheduling policy implements, and the policy chosen at boot
+//
+// Andrew Chen
+// 10/2026
+
+#include <string.h>
+#include <ykernel.h>
+#include <scheduler.h>
+
+// name of the policy to use, set with the sched boot option
+char *sched_policy_name = "mlfq";
+
+// clock ticks a process runs before the scheduler may switch away from it, set with the quantum boot option
+int default_quantum_ticks = 1;
+
+// the policy in use
+SchedOps_t *sched = &mlfq_sched_ops;
+
+SchedOps_t *sched_policies[] = {
+  &rr_sched_ops,
+  &mlfq_sched_ops,
+  &stride_sched_ops,
+  NULL
+};
+
+// selects the policy named sched_policy_name and initializes it
+void InitScheduler() {
+  sched = &mlfq_sched_ops;
+  for (int i = 0; sched_policies[i] != NULL; i++) {
+    if (strcmp(sched_policies[i]->name, sched_policy_name) == 0) {
+      sched = sched_policies[i];
+      break;
+    }
+  }
+  if (strcmp(sched->name, sched_policy_name) != 0) {
+    TracePrintf(0, "InitScheduler: unknown policy '%s', using %s\n", sched_policy_name, sched->name);
+  }
+  TracePrintf(1, "InitScheduler: scheduling with %s\n", sched->name);
+  sched->init();
+}
+
+// returns the number of clock ticks a process runs before it may be switched away from
+// a quantum of 0 in the pcb means the process never set one, so the default given at boot applies
+int SchedQuantum(pcb_t *pcb) {
+  if (pcb->sched_quantum > 0) {
+    return pcb->sched_quantum;
+  }
+  return default_quantum_ticks > 0 ? default_quantum_ticks : 1;
+}
+
+// adds a ready process to the policy's set of ready processes
+// returns -1 if the process is already queued, in which case it is left where it is
+int SchedEnqueue(pcb_t *pcb) {
+  if (sched->enqueue(pcb) == -1) {
+    return -1;
+  }
+  pcb->sched_ready = 1;
+  return 0;
+}
+
+// adds a ready process that should run as soon as the policy allows
+// returns -1 if the process is already queued, in which case it is left where it is
+int SchedEnqueueFront(pcb_t *pcb) {
+  if (sched->enqueue_front(pcb) == -1) {
+    return -1;
+  }
+  pcb->sched_ready = 1;
+  return 0;
+}
+
+// removes and returns the ready process to run next, NULL if none is ready
+pcb_t *SchedDequeue() {
+  pcb_t *pcb = sched->dequeue();
+  if (pcb != NULL) {
+    pcb->sched_ready = 0;
+  }
+  return pcb;
+}
+
+// charges a clock tick to the running process, returns 1 if it should give up the cpu
+int SchedTick(pcb_t *pcb) {
+  return sched->tick(pcb);
+}
+
+// tells the policy the running process is about to block
+void SchedBlock(pcb_t *pcb) {
+  if (sched->block != NULL) {
+    sched->block(pcb);
+  }
+}
+
+// tells the policy a process that blocked on a terminal, pipe, lock or cvar is about to be made ready
+void SchedWake(pcb_t *pcb) {
+  if (sched->wake != NULL) {
+    sched->wake(pcb);
+  }
+}
+
+// prints which policy ran and what it counted
+void PrintSchedStats() {
+  TracePrintf(0, "sched: %s\n", sched->name);
+  if (sched->print_stats != NULL) {
+    sched->print_stats();
+  }
+}
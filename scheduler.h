@@ -0,0 +1,76 @@
+// Contains the interface every scheduling policy implements, and the policy chosen at boot
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _scheduler_h
+#define _scheduler_h
+
+#include <ykernel.h>
+#include <pcb.h>
+
+// tickets a process holds under the stride policy until it is given others, inherited on Fork
+#define SCHED_DEFAULT_TICKETS 100
+
+// the operations a scheduling policy provides
+// the dispatch code in process_controller.c decides when a process runs, blocks or wakes up,
+// and the policy only decides the order ready processes run in and when the running one is preempted
+struct SchedOps {
+  char *name;                     // name given as sched=name on the command line
+  void (*init)();                 // sets up an empty set of ready processes
+  int (*enqueue)(pcb_t *pcb);     // adds a ready process, normally behind the others, returns -1 if it is already queued
+  int (*enqueue_front)(pcb_t *pcb); // adds a ready process that should run as soon as the policy allows, returns -1 if it is already queued
+  pcb_t *(*dequeue)();            // removes and returns the ready process to run next, NULL if none is ready
+  int (*tick)(pcb_t *pcb);        // charges a clock tick to the running process, returns 1 if it should be preempted
+                                  // a policy lets a process run for SchedQuantum ticks before it preempts it for its turn
+  void (*block)(pcb_t *pcb);      // the running process is about to block, may be NULL
+  void (*wake)(pcb_t *pcb);       // a process blocked on a terminal, pipe, lock or cvar is about to be made ready, may be NULL
+  void (*print_stats)();          // prints what the policy counted, may be NULL
+};
+
+typedef struct SchedOps SchedOps_t;
+
+// clock ticks a process runs before the scheduler may switch away from it, unless it sets its own with SetQuantum
+extern int default_quantum_ticks;
+
+// the policies to choose from
+extern SchedOps_t rr_sched_ops;
+extern SchedOps_t mlfq_sched_ops;
+extern SchedOps_t stride_sched_ops;
+
+// the policy in use
+extern SchedOps_t *sched;
+
+// name of the policy to use, set with the sched boot option
+extern char *sched_policy_name;
+
+// selects the policy named sched_policy_name and initializes it, falling back to mlfq if there is no such policy
+void InitScheduler();
+
+// returns the number of clock ticks a process runs before it may be switched away from
+int SchedQuantum(pcb_t *pcb);
+
+// adds a ready process to the policy's set of ready processes
+// returns -1 if the process is already queued, in which case it is left where it is
+int SchedEnqueue(pcb_t *pcb);
+
+// adds a ready process that should run as soon as the policy allows
+// returns -1 if the process is already queued, in which case it is left where it is
+int SchedEnqueueFront(pcb_t *pcb);
+
+// removes and returns the ready process to run next, NULL if none is ready
+pcb_t *SchedDequeue();
+
+// charges a clock tick to the running process, returns 1 if it should give up the cpu
+int SchedTick(pcb_t *pcb);
+
+// tells the policy the running process is about to block
+void SchedBlock(pcb_t *pcb);
+
+// tells the policy a process that blocked on a terminal, pipe, lock or cvar is about to be made ready
+void SchedWake(pcb_t *pcb);
+
+// prints which policy ran and what it counted
+void PrintSchedStats();
+
+#endif
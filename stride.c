@@ -0,0 +1,96 @@
+// Contains the stride scheduling policy, which shares the cpu among ready processes in proportion to their tickets
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <kernel.h>
+#include <queue.h>
+#include <scheduler.h>
+
+// pass a process with one ticket advances by on each tick it runs
+#define STRIDE_ONE (1 << 16)
+
+// ready processes sorted by pass, smallest first
+Queue_t *stride_queue;
+
+// pass of the process dispatched last, which a process joining the ready set is brought up to
+// so that time spent blocked is not saved up as a claim on the cpu
+long long stride_global_pass = 0;
+
+int num_stride_catch_ups = 0;
+
+// creates the empty list of ready processes
+void StrideInit() {
+  stride_queue = createQueue();
+  stride_global_pass = 0;
+}
+
+// adds a ready process after every process whose pass is not larger than its own
+int StrideEnqueue(pcb_t *pcb) {
+  // a queued process is sorted by its pass, which must not change until it is dequeued
+  if (pcb->queue != NULL) {
+    TracePrintf(0, "StrideEnqueue: pid %d is already queued\n", pcb->pid);
+    return -1;
+  }
+  if (pcb->sched_pass < stride_global_pass) {
+    pcb->sched_pass = stride_global_pass;
+    num_stride_catch_ups++;
+  }
+
+  pcb_t *prev = NULL;
+  pcb_t *next = stride_queue->front;
+  while (next != NULL && next->sched_pass <= pcb->sched_pass) {
+    prev = next;
+    next = next->queue_next;
+  }
+  return enQueueAfter(stride_queue, prev, pcb);
+}
+
+// a woken process takes its place by pass like any other, since its pass was brought up when it joins
+int StrideEnqueueFront(pcb_t *pcb) {
+  return StrideEnqueue(pcb);
+}
+
+// removes and returns the ready process with the smallest pass, which starts a fresh quantum
+pcb_t *StrideDequeue() {
+  pcb_t *pcb = deQueue(stride_queue);
+  if (pcb != NULL) {
+    stride_global_pass = pcb->sched_pass;
+    pcb->sched_ticks = 0;
+  }
+  return pcb;
+}
+
+// advances the pass of the running process by its stride, and preempts it once it has run
+// for its quantum and a ready process has a pass no larger than its own
+int StrideTick(pcb_t *pcb) {
+  if (pcb == idle_pcb) {
+    return 1;
+  }
+  int tickets = pcb->sched_tickets > 0 ? pcb->sched_tickets : SCHED_DEFAULT_TICKETS;
+  pcb->sched_pass += STRIDE_ONE / tickets;
+  pcb->sched_ticks++;
+  if (pcb->sched_ticks < SchedQuantum(pcb)) {
+    return 0;
+  }
+  pcb->sched_ticks = 0;
+  return stride_queue->front != NULL && stride_queue->front->sched_pass <= pcb->sched_pass;
+}
+
+// prints how often a process rejoining the ready set had to be brought up to the global pass
+void PrintStrideStats() {
+  TracePrintf(0, "stride: global pass %lld, %d catch ups\n", stride_global_pass, num_stride_catch_ups);
+}
+
+SchedOps_t stride_sched_ops = {
+  "stride",
+  StrideInit,
+  StrideEnqueue,
+  StrideEnqueueFront,
+  StrideDequeue,
+  StrideTick,
+  NULL,
+  NULL,
+  PrintStrideStats
+};
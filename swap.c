@@ -0,0 +1,322 @@
+// Contains the swap subsystem that evicts cold user pages to compressed memory or a host file when frames run out
+//
+// Andrew Chen
+// 10/2026
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <ykernel.h>
+#include <kernel.h>
+#include <frame_manager.h>
+#include <pte_manager.h>
+#include <page_fault.h>
+#include <swap.h>
+#include <zram.h>
+
+// file backing the swap slots, -1 if swapping is unavailable
+int swap_fd = -1;
+
+// path of the swap file given with the swap_file boot option, NULL for a fresh file per run
+char *swap_file_name = NULL;
+
+// stack of free swap slots
+int swap_free_slots[SWAP_SLOTS];
+
+// number of slots in swap_free_slots
+int num_free_swap_slots = 0;
+
+// page the clock hand points at, swept across every page of every pcb in all_pcbs
+pcb_t *clock_pcb = NULL;
+int clock_page = 0;
+
+// set while ReclaimFrame runs, so that a nested allocation does not reclaim again
+int is_reclaiming = 0;
+
+// number of pages written to and read back from swap
+int num_swap_outs = 0;
+int num_swap_ins = 0;
+
+// number of faults on compressed and swapped out pages, and the microseconds spent resolving them
+int num_zram_faults = 0;
+long zram_fault_usec = 0;
+int num_swap_faults = 0;
+long swap_fault_usec = 0;
+
+// creates the swap file and marks every slot in it free
+int InitSwap() {
+  if (swap_file_name != NULL) {
+    swap_fd = open(swap_file_name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (swap_fd < 0) {
+      TracePrintf(1, "InitSwap: can't open swap file '%s'\n", swap_file_name);
+      return -1;
+    }
+  } else {
+    // named after this run so that two kernels in one directory never share a file, and
+    // unlinked once open so that it goes away with the kernel
+    char path[32];
+    snprintf(path, sizeof(path), "%s.%d", SWAP_FILE, getpid());
+    swap_fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (swap_fd < 0) {
+      TracePrintf(1, "InitSwap: can't create swap file '%s'\n", path);
+      return -1;
+    }
+    unlink(path);
+  }
+  for (int slot = SWAP_SLOTS - 1; slot >= 0; slot--) {
+    swap_free_slots[num_free_swap_slots] = slot;
+    num_free_swap_slots++;
+  }
+  return 0;
+}
+
+// prints how much was evicted to each store and how long faults on evicted pages took
+void PrintSwapStats() {
+  TracePrintf(0, "zram: %d pages stored, %d rejected, %d loaded, %ld bytes held\n",
+              num_zram_stores, num_zram_rejects, num_zram_loads, zram_bytes_used);
+  if (zram_bytes_out > 0) {
+    TracePrintf(0, "zram: compression ratio %ld.%02ld\n",
+                zram_bytes_in / zram_bytes_out, (zram_bytes_in * 100 / zram_bytes_out) % 100);
+  }
+  if (num_zram_faults > 0) {
+    TracePrintf(0, "zram: %d faults, %ld usec average\n", num_zram_faults, zram_fault_usec / num_zram_faults);
+  }
+  TracePrintf(0, "swap: %d pages written, %d read back\n", num_swap_outs, num_swap_ins);
+  if (num_swap_faults > 0) {
+    TracePrintf(0, "swap: %d faults, %ld usec average\n", num_swap_faults, swap_fault_usec / num_swap_faults);
+  }
+}
+
+// returns the number of microseconds from start to now
+long UsecSince(struct timeval *start) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_usec - start->tv_usec);
+}
+
+// returns the page the clock hand points at and moves the hand on to the next one
+// returns NULL if there are no pcbs
+pcb_t *AdvanceClock(int *page) {
+  if (clock_pcb == NULL) {
+    clock_pcb = all_pcbs;
+    clock_page = 0;
+  }
+  pcb_t *pcb = clock_pcb;
+  if (pcb == NULL) {
+    return NULL;
+  }
+  *page = clock_page;
+  clock_page++;
+  if (clock_page == MAX_PT_LEN) {
+    clock_pcb = clock_pcb->all_next;
+    clock_page = 0;
+  }
+  return pcb;
+}
+
+// returns 1 if a resident page is mapped by no other page table, so it can be sampled and evicted
+int IsSwappable(pcb_t *pcb, int page) {
+  pte_t *pt = pcb->pt_addr;
+  return pt[page].valid == 1 && pcb->page_state[page] == PAGE_RESIDENT && FrameRefCount(pt[page].pfn) == 1;
+}
+
+// revokes the valid bit of a resident page so that its next reference faults
+void SamplePage(pcb_t *pcb, int page) {
+  pte_t *pt = pcb->pt_addr;
+  pt[page].valid = 0;
+  pcb->page_state[page] = PAGE_SAMPLED;
+  if (pcb == curr_pcb) {
+    FlushTLB((unsigned int) REGION_1_PAGE_ADDR(page));
+  }
+}
+
+// evicts a sampled page and frees its frame
+// the page is compressed into zram if it compresses well, and written to a free swap slot otherwise
+int SwapOutPage(pcb_t *pcb, int page) {
+  pte_t *pte = &((pte_t *) pcb->pt_addr)[page];
+  void *addr = KMap(pte->pfn);
+  if (addr == NULL) {
+    return -1;
+  }
+
+  int entry = ZramStore(addr);
+  if (entry != -1) {
+    KUnmap(addr);
+    ReleaseFrame(pte->pfn);
+    pte->pfn = entry;
+    pcb->page_state[page] = PAGE_COMPRESSED;
+    return 0;
+  }
+
+  if (swap_fd < 0 || num_free_swap_slots == 0) {
+    KUnmap(addr);
+    TracePrintf(1, "SwapOutPage: no room to evict page %d\n", page);
+    return -1;
+  }
+  int slot = swap_free_slots[num_free_swap_slots - 1];
+  lseek(swap_fd, (long) slot << PAGESHIFT, SEEK_SET);
+  int rc = write(swap_fd, addr, PAGESIZE);
+  KUnmap(addr);
+  if (rc != PAGESIZE) {
+    TracePrintf(1, "SwapOutPage: failed to write slot %d\n", slot);
+    return -1;
+  }
+  num_free_swap_slots--;
+
+  ReleaseFrame(pte->pfn);
+  pte->pfn = slot;
+  pcb->page_state[page] = PAGE_SWAPPED;
+  num_swap_outs++;
+  return 0;
+}
+
+// advances the clock hand under memory pressure, revoking the valid bit of each private page it passes
+// a page that is not referenced again before the hand comes back around is evicted by ReclaimFrame
+void SampleColdPages() {
+  if (NumFreeFrames() >= SWAP_LOW_FRAMES) {
+    return;
+  }
+  for (int i = 0; i < SWAP_SAMPLE_PAGES; i++) {
+    int page;
+    pcb_t *pcb = AdvanceClock(&page);
+    if (pcb == NULL) {
+      return;
+    }
+    // the kernel may be in the middle of using a page of the current process
+    if (pcb != curr_pcb && IsSwappable(pcb, page)) {
+      SamplePage(pcb, page);
+    }
+  }
+}
+
+// frees one frame by compressing a sampled page into zram or writing it out to swap, giving resident pages a second chance on the way
+// pages of the current process are only evicted once sampled, since the kernel may be using them
+// returns -1 if nothing could be evicted
+int ReclaimFrame() {
+  if (is_reclaiming) {
+    return -1;
+  }
+  is_reclaiming = 1;
+
+  // two trips around every page give each page sampled on the first trip a chance to be evicted on the second
+  int limit = 2 * num_pcbs * MAX_PT_LEN;
+  for (int i = 0; i < limit; i++) {
+    int page;
+    pcb_t *pcb = AdvanceClock(&page);
+    if (pcb == NULL) {
+      break;
+    }
+    if (pcb->page_state[page] == PAGE_SAMPLED) {
+      if (SwapOutPage(pcb, page) == 0) {
+        is_reclaiming = 0;
+        return 0;
+      }
+    } else if (pcb != curr_pcb && IsSwappable(pcb, page)) {
+      SamplePage(pcb, page);
+    }
+  }
+
+  is_reclaiming = 0;
+  TracePrintf(1, "ReclaimFrame: no page could be evicted\n");
+  return -1;
+}
+
+// makes a sampled, compressed or swapped out region 1 page of the current process resident again
+int RestorePage(int page) {
+  pte_t *pte = &((pte_t *) curr_pcb->pt_addr)[page];
+  void *page_addr = REGION_1_PAGE_ADDR(page);
+  int state = curr_pcb->page_state[page];
+  if (state == PAGE_SAMPLED) {
+    pte->valid = 1;
+    curr_pcb->page_state[page] = PAGE_RESIDENT;
+    FlushTLB((unsigned int) page_addr);
+    return 0;
+  }
+  if (state != PAGE_SWAPPED && state != PAGE_COMPRESSED) {
+    return 0;
+  }
+
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  int frame = AllocateFrame();
+  if (frame == -1) {
+    TracePrintf(1, "RestorePage: failed to allocate frame for page %d\n", page);
+    return -1;
+  }
+  void *addr = KMap(frame);
+  if (addr == NULL) {
+    DeallocateFrame(frame);
+    return -1;
+  }
+
+  int rc;
+  if (state == PAGE_COMPRESSED) {
+    rc = ZramLoad(pte->pfn, addr);
+  } else {
+    lseek(swap_fd, (long) pte->pfn << PAGESHIFT, SEEK_SET);
+    rc = read(swap_fd, addr, PAGESIZE) == PAGESIZE ? 0 : -1;
+  }
+  KUnmap(addr);
+  if (rc == -1) {
+    TracePrintf(1, "RestorePage: failed to read back page %d\n", page);
+    DeallocateFrame(frame);
+    return -1;
+  }
+
+  if (state == PAGE_COMPRESSED) {
+    num_zram_faults++;
+    zram_fault_usec += UsecSince(&start);
+  } else {
+    swap_free_slots[num_free_swap_slots] = pte->pfn;
+    num_free_swap_slots++;
+    num_swap_ins++;
+    num_swap_faults++;
+    swap_fault_usec += UsecSince(&start);
+  }
+  pte->pfn = frame;
+  pte->valid = 1;
+  curr_pcb->page_state[page] = PAGE_RESIDENT;
+  FlushTLB((unsigned int) page_addr);
+  return 0;
+}
+
+// makes every sampled, compressed or swapped out page of the current process resident again
+int RestoreAllPages() {
+  for (VMA_t *vma = curr_pcb->vmas; vma != NULL; vma = vma->next) {
+    for (int page = vma->start; page < vma->end; page++) {
+      if (RestorePage(page) == -1) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+// drops the swap state of pages [start, end) of a pcb before they are cleared
+// sampled pages are made valid again so that ClearPTERegion releases their frames,
+// and the zram entries and swap slots of evicted pages are freed
+void ForgetPages(pcb_t *pcb, int start, int end) {
+  pte_t *pt = pcb->pt_addr;
+  for (int page = start; page < end; page++) {
+    if (pcb->page_state[page] == PAGE_SAMPLED) {
+      pt[page].valid = 1;
+    } else if (pcb->page_state[page] == PAGE_SWAPPED) {
+      swap_free_slots[num_free_swap_slots] = pt[page].pfn;
+      num_free_swap_slots++;
+      bzero(&pt[page], sizeof(pte_t));
+    } else if (pcb->page_state[page] == PAGE_COMPRESSED) {
+      ZramFree(pt[page].pfn);
+      bzero(&pt[page], sizeof(pte_t));
+    }
+    pcb->page_state[page] = PAGE_RESIDENT;
+  }
+}
+
+// moves the clock hand off a pcb that is about to be freed
+void SwapRemovePCB(pcb_t *pcb) {
+  if (clock_pcb == pcb) {
+    clock_pcb = pcb->all_next;
+    clock_page = 0;
+  }
+}
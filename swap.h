@@ -0,0 +1,66 @@
+// Contains the swap subsystem that evicts cold user pages to compressed memory or a host file when frames run out
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _swap_h
+#define _swap_h
+
+#include <ykernel.h>
+#include <pcb.h>
+
+// host file standing in for a swap disk, created fresh at boot as SWAP_FILE.<host pid> unless the
+// swap_file boot option names one
+#define SWAP_FILE "SWAPFILE"
+
+// path of the swap file given with the swap_file boot option, NULL for a fresh file per run
+extern char *swap_file_name;
+
+// number of pages the swap file can hold
+#define SWAP_SLOTS 4096
+
+// pages are only sampled for reference while fewer than this many frames are free
+#define SWAP_LOW_FRAMES 64
+
+// number of pages the clock hand passes on each clock tick under memory pressure
+#define SWAP_SAMPLE_PAGES 32
+
+// swap state of a region 1 page, kept in the pcb alongside its page table entry
+#define PAGE_RESIDENT 0   // the page table entry alone describes the page
+#define PAGE_SAMPLED 1    // valid bit revoked to catch the next reference, pfn and prot still hold the frame
+#define PAGE_SWAPPED 2    // pfn holds the swap slot, prot the protection the page is restored with
+#define PAGE_COMPRESSED 3 // pfn holds the zram entry, prot the protection the page is restored with
+
+extern int num_swap_outs;
+extern int num_swap_ins;
+
+// creates the swap file and marks every slot in it free
+int InitSwap();
+
+// prints how much was evicted to each store and how long faults on evicted pages took
+void PrintSwapStats();
+
+// advances the clock hand under memory pressure, revoking the valid bit of each private page it passes
+// a page that is not referenced again before the hand comes back around is evicted by ReclaimFrame
+void SampleColdPages();
+
+// frees one frame by compressing a sampled page into zram or writing it out to swap, giving resident pages a second chance on the way
+// pages of the current process are only evicted once sampled, since the kernel may be using them
+// returns -1 if nothing could be evicted
+int ReclaimFrame();
+
+// makes a sampled, compressed or swapped out region 1 page of the current process resident again
+int RestorePage(int page);
+
+// makes every sampled, compressed or swapped out page of the current process resident again
+int RestoreAllPages();
+
+// drops the swap state of pages [start, end) of a pcb before they are cleared
+// sampled pages are made valid again so that ClearPTERegion releases their frames,
+// and the zram entries and swap slots of evicted pages are freed
+void ForgetPages(pcb_t *pcb, int start, int end);
+
+// moves the clock hand off a pcb that is about to be freed
+void SwapRemovePCB(pcb_t *pcb);
+
+#endif
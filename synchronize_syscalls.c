@@ -8,6 +8,8 @@
 #include <synchronize_syscalls.h>
 #include <queue.h>
 #include <process_controller.h>
+#include <page_fault.h>
+#include <scheduler.h>
 
 enum ObjectType {
   LOCK,
@@ -79,6 +81,10 @@ int CreateSyncObject(enum ObjectType object_type) {
 
 // Create a new lock; save its identifier at *lock idp. In case of any error, the value ERROR is returned.
 int KernelLockInit(int *lock_idp){
+  if (PrepareUserWrite(lock_idp, sizeof(int)) == -1) {
+    TracePrintf(1, "KernelLockInit: lock_idp is not writable\n");
+    return -1;
+  }
   int lock_id = CreateSyncObject(LOCK);
   if (lock_id == -1) {
     TracePrintf(1, "KernelLockInit: failed to create sync object\n");
@@ -110,54 +116,73 @@ int KernelLockAcquire(int lock_id, UserContext* uc){
     // block the current process and add it to the lock wait queue
     enQueue(lock->queue, curr_pcb);
     // switch off the current process until we get the lock
-    SwitchPCB(uc, 0, NULL);
+    SwitchPCB(uc, SWITCH_BLOCK, NULL);
+    // the releasing process handed the lock straight to us, so no one can take it in between
+    // sync_objects may have grown while we were blocked, so look the lock up again
+    lock = &sync_objects[lock_id];
+    if (lock->holder_id != curr_pcb->pid) {
+      TracePrintf(1, "KernelLockAcquire: unblocked lock waiter wasn't handed the lock\n");
+      return -1;
+    }
   }
-  // the lock should now be unacquired
-  if (lock->holder_id != -1) {
-    TracePrintf(1, "KernelLockAcquire: unblocked lock waiter's lock should be unacquired but isn't \n");
-    return -1;
-  } 
 
   // acquire the lock
   lock->holder_id = curr_pcb->pid;
   return 0;
 }
 
-// Release the lock identified by lock id. The caller must currently hold this lock. 
-// In case of any error, the value ERROR is returned.
-int KernelLockRelease(int lock_id, UserContext* uc){
+// Releases a lock held by the current process and hands it to the first process waiting for it, if any.
+// With switch_to_waiter the current process switches to that waiter right away,
+// otherwise the waiter is only made ready, so the current process can block somewhere else next.
+int ReleaseLock(int lock_id, UserContext* uc, int switch_to_waiter){
   // error checking
   if (lock_id < 0) {
-    TracePrintf(1, "KernelLockRelease: lock_id below bounds\n");
+    TracePrintf(1, "ReleaseLock: lock_id below bounds\n");
     return -1;
   }
   if (lock_id >= sync_objects_entries) {
-    TracePrintf(1, "KernelLockRelease: lock_id above bounds\n");
+    TracePrintf(1, "ReleaseLock: lock_id above bounds\n");
     return -1;
   }
   SyncNode_t *lock = &sync_objects[lock_id];
   if (lock->object_type != LOCK) {
-    TracePrintf(1, "KernelLockRelease: lock_id does not correspond to a lock\n");
+    TracePrintf(1, "ReleaseLock: lock_id does not correspond to a lock\n");
     return -1;
   }
   if (curr_pcb->pid != lock->holder_id) {
-    TracePrintf(1, "KernelLockRelease: curr_pcb does not currently hold the lock\n");
+    TracePrintf(1, "ReleaseLock: curr_pcb does not currently hold the lock\n");
     return -1;
   }
 
   // release the lock
   lock->holder_id = -1;
 
-  // unblock a lock waiter and switch to it
+  // unblock a lock waiter, handing it the lock, and switch to it
   pcb_t* lock_waiter = deQueue(lock->queue);
   if (lock_waiter != NULL) {
-    SwitchPCB(uc, 1, lock_waiter);
+    lock->holder_id = lock_waiter->pid;
+    SchedWake(lock_waiter);
+    if (switch_to_waiter) {
+      SwitchPCB(uc, SWITCH_REQUEUE, lock_waiter);
+    } else {
+      AddPCBFront(lock_waiter);
+    }
   }
   return 0;
 }
 
+// Release the lock identified by lock id. The caller must currently hold this lock. 
+// In case of any error, the value ERROR is returned.
+int KernelLockRelease(int lock_id, UserContext* uc){
+  return ReleaseLock(lock_id, uc, 1);
+}
+
 // Create a new condition variable; save its identifier at *cvar idp. In case of any error, the value ERROR is returned.
 int KernelCvarInit(int *cvar_idp){
+  if (PrepareUserWrite(cvar_idp, sizeof(int)) == -1) {
+    TracePrintf(1, "KernelCvarInit: cvar_idp is not writable\n");
+    return -1;
+  }
   int cvar_id = CreateSyncObject(CVAR);
   if (cvar_id == -1) {
     TracePrintf(1, "KernelCvarInit: failed to create sync object\n");
@@ -187,6 +212,7 @@ int KernelCvarSignal(int cvar_id){
   // unblock a cvar waiter
   pcb_t* cvar_waiter = deQueue(cvar->queue);
   if (cvar_waiter != NULL) {
+    SchedWake(cvar_waiter);
     AddPCBFront(cvar_waiter);
   }
   return 0;
@@ -213,6 +239,7 @@ int KernelCvarBroadcast(int cvar_id){
   // unblock a cvar waiter
   pcb_t* cvar_waiter = deQueue(cvar->queue);
   while (cvar_waiter != NULL) {
+    SchedWake(cvar_waiter);
     AddPCBFront(cvar_waiter);
     cvar_waiter = deQueue(cvar->queue);
   }
@@ -238,18 +265,20 @@ int KernelCvarWait(int cvar_id, int lock_id, UserContext *uc){
     return -1;
   }
 
-  // wait for the cvar
-  // block the current process and add it to the cvar wait queue
-  enQueue(cvar->queue, curr_pcb);
-
-  // release the lock
-  int rc = KernelLockRelease(lock_id, uc);
+  // release the lock without switching away, since the current process is about to block on the cvar
+  // and a process is only ever on one queue
+  int rc = ReleaseLock(lock_id, uc, 0);
   if (rc == -1) {
     TracePrintf(1, "KernelCvarWait: failed to release lock\n");
     return -1;
   }
+
+  // wait for the cvar
+  // block the current process and add it to the cvar wait queue
+  // nothing else runs before the switch below, so no signal can be missed in between
+  enQueue(cvar->queue, curr_pcb);
   // switch off the current process until we get signalled or broadcasted
-  SwitchPCB(uc, 0, NULL);
+  SwitchPCB(uc, SWITCH_BLOCK, NULL);
 
 
   // acquire the lock
@@ -278,6 +307,11 @@ int KernelReclaim(int id){
     TracePrintf(1, "KernelReclaim: object is already reclaimed\n");
     return -1;
   }
+  // processes still waiting on the object would never be woken up again
+  if (((Queue_t *) object->queue)->len > 0) {
+    TracePrintf(1, "KernelReclaim: %d processes are still waiting on object %d\n", ((Queue_t *) object->queue)->len, id);
+    return -1;
+  }
   
   if (object->object_type == LOCK) { // lock
     freeQueue(object->queue);
@@ -304,6 +338,10 @@ int
 KernelPipeInit(int *pipe_idp)
 {
   
+  if (PrepareUserWrite(pipe_idp, sizeof(int)) == -1) {
+    TracePrintf(1, "KernelPipeInit: pipe_idp is not writable\n");
+    return -1;
+  }
   int pipe_id = CreateSyncObject(PIPE);
   if (pipe_id == -1) {
     TracePrintf(1, "KernelCvarInit: failed to create sync object\n");
@@ -337,7 +375,14 @@ KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uc)
     // block the current process and add it to the pipe wait queue
     enQueue(pipe->queue, curr_pcb);
     // switch off the current process until this process becomes unblocked
-    SwitchPCB(uc, 0, NULL);
+    SwitchPCB(uc, SWITCH_BLOCK, NULL);
+    // sync_objects may have grown while we were blocked, so look the pipe up again
+    pipe = &sync_objects[pipe_id];
+  }
+
+  if (PrepareUserWrite(buf, len < pipe->len ? len : pipe->len) == -1) {
+    TracePrintf(1, "KernelPipeRead: buf is not writable\n");
+    return ERROR;
   }
 
   if (pipe->len <= len) {
@@ -378,12 +423,18 @@ KernelPipeWrite(int pipe_id, void *buf, int len)
   	return ERROR;
   }
 
+  if (PrepareUserRead(buf, len) == -1) {
+    TracePrintf(1, "KernelPipeWrite: buf is not readable\n");
+    return ERROR;
+  }
+
   memcpy(pipe->buf + pipe->len, buf, sizeof(char) * len);
   pipe->len += len;
   
   // unblock a pipe waiter and switch to it
   pcb_t* pipe_waiter = deQueue(pipe->queue);
   if (pipe_waiter != NULL) {
+    SchedWake(pipe_waiter);
     AddPCBFront(pipe_waiter);
   }
 
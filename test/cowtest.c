@@ -0,0 +1,34 @@
+/*
+ cowtest.c
+ Checks that a forked child and its parent stop sharing a page once either writes to it
+*/
+
+#include <yuser.h>
+
+int shared_global = 1;
+
+int main(int argc, char *argv[]) {
+    int *heap_value = malloc(sizeof(int));
+    *heap_value = 10;
+    int stack_value = 100;
+    int status;
+
+    int pid = Fork();
+    if (pid == 0) {
+        TracePrintf(0, "===cowtest=== CHILD: (expect 1 10 100) %d %d %d\n", shared_global, *heap_value, stack_value);
+        shared_global = 2;
+        *heap_value = 20;
+        stack_value = 200;
+        TracePrintf(0, "===cowtest=== CHILD: (expect 2 20 200) %d %d %d\n", shared_global, *heap_value, stack_value);
+        Exit(shared_global + *heap_value + stack_value);
+    }
+
+    // the parent writes a different value than the child to every shared page
+    shared_global = 3;
+    *heap_value = 30;
+    stack_value = 300;
+    Wait(&status);
+    TracePrintf(0, "===cowtest=== PARENT: (expect 222) child status %d\n", status);
+    TracePrintf(0, "===cowtest=== PARENT: (expect 3 30 300) %d %d %d\n", shared_global, *heap_value, stack_value);
+    Exit(0);
+}
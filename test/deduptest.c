@@ -0,0 +1,56 @@
+/*
+ deduptest.c
+ Checks that pages merged because they hold the same bytes are split again
+ when one of the processes sharing them writes, and prints dedup stats at halt
+*/
+
+#include <yuser.h>
+
+#define PAGE_BYTES 8192
+#define NUM_CHILDREN 4
+#define NUM_PAGES 16
+
+int main(int argc, char *argv[]) {
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            // every child fills its heap with the same bytes, so the scanner can merge them
+            int words = PAGE_BYTES / sizeof(int);
+            int *heap = malloc(NUM_PAGES * PAGE_BYTES);
+            for (int page = 0; page < NUM_PAGES; page++) {
+                for (int w = 0; w < words; w++) {
+                    heap[page * words + w] = page * 7 + w;
+                }
+            }
+
+            // give the scanner idle ticks to find the duplicates
+            Delay(20);
+
+            // now make every page different in each child
+            for (int page = 0; page < NUM_PAGES; page++) {
+                heap[page * words] = i;
+            }
+            Delay(2);
+
+            int errors = 0;
+            for (int page = 0; page < NUM_PAGES; page++) {
+                if (heap[page * words] != i || heap[page * words + 1] != page * 7 + 1) {
+                    errors++;
+                }
+            }
+            TracePrintf(0, "===deduptest=== CHILD %d: (expect 0) %d bad pages\n", i, errors);
+            Exit(errors);
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        int status;
+        Wait(&status);
+        if (status != 0) {
+            failed++;
+        }
+    }
+    TracePrintf(0, "===deduptest=== PARENT: (expect 0) %d children saw bad pages\n", failed);
+    Exit(0);
+}
@@ -0,0 +1,40 @@
+/*
+ delaytest.c
+ Checks that many processes sleeping in Delay at once all wake up, including
+ sleeps longer than one turn of the kernel's timing wheel
+*/
+
+#include <yuser.h>
+
+#define NUM_SLEEPERS 32
+#define LONG_DELAY 300
+
+int main(int argc, char *argv[]) {
+    // with nothing else ready, Delay still has to put the only process to sleep
+    TracePrintf(0, "===delaytest=== lone delay (expect 0) %d\n", Delay(3));
+
+    for (int i = 0; i < NUM_SLEEPERS; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            Delay(i % 8 + 1);
+            Delay(i % 8 + 1);
+            Exit(i);
+        }
+    }
+    int pid = Fork();
+    if (pid == 0) {
+        Delay(LONG_DELAY);
+        Exit(NUM_SLEEPERS);
+    }
+
+    int done = 0;
+    int status;
+    for (int i = 0; i <= NUM_SLEEPERS; i++) {
+        if (Wait(&status) != ERROR) {
+            done++;
+        }
+    }
+    TracePrintf(0, "===delaytest=== sleepers woken (expect %d) %d\n", NUM_SLEEPERS + 1, done);
+    TracePrintf(0, "===delaytest=== last to wake (expect %d) %d\n", NUM_SLEEPERS, status);
+    Exit(0);
+}
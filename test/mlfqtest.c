@@ -0,0 +1,42 @@
+/*
+ mlfqtest.c
+ Checks that a process that keeps blocking on the terminal stays responsive while CPU hogs run
+ The interactive rounds should all be printed before any hog finishes, however many hogs there are
+*/
+
+#include <yuser.h>
+
+#define NUM_HOGS 4
+#define HOG_LOOPS 50000000
+#define NUM_ROUNDS 10
+
+int main(int argc, char *argv[]) {
+    for (int i = 0; i < NUM_HOGS; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            // never blocks, so it sinks to the lowest level
+            volatile int sum = 0;
+            for (int j = 0; j < HOG_LOOPS; j++) {
+                sum += j;
+            }
+            TracePrintf(0, "===mlfqtest=== hog %d done\n", i);
+            Exit(i);
+        }
+    }
+
+    // blocks on the terminal every round, so it is boosted back to the top level each time
+    for (int round = 0; round < NUM_ROUNDS; round++) {
+        TtyPrintf(0, "mlfqtest: interactive round %d\n", round);
+        TracePrintf(0, "===mlfqtest=== round %d (expect before any hog is done)\n", round);
+    }
+
+    int done = 0;
+    int status;
+    for (int i = 0; i < NUM_HOGS; i++) {
+        if (Wait(&status) != ERROR) {
+            done++;
+        }
+    }
+    TracePrintf(0, "===mlfqtest=== hogs reaped (expect %d) %d\n", NUM_HOGS, done);
+    Exit(0);
+}
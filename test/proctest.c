@@ -0,0 +1,73 @@
+/*
+ proctest.c
+ Checks that ProcList reports every process, with its parent and what it is
+ doing, in a single call
+*/
+
+#include <yuser.h>
+#include <custom_syscalls.h>
+
+#define NUM_CHILDREN 3
+#define SLEEP_TICKS 20
+#define MAX_PROCS 64
+
+ProcInfo_t procs[MAX_PROCS];
+
+// returns the snapshot of pid in the first n entries of procs, NULL if it is not there
+ProcInfo_t *find(int n, int pid) {
+    for (int i = 0; i < n; i++) {
+        if (procs[i].pid == pid) {
+            return &procs[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int self = GetPid();
+    int children[NUM_CHILDREN];
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        children[i] = Fork();
+        if (children[i] == 0) {
+            // the first child exits straight away and stays a zombie until it is collected
+            if (i > 0) {
+                Delay(SLEEP_TICKS);
+            }
+            Exit(i);
+        }
+    }
+    // give the first child a chance to exit
+    Delay(1);
+
+    int total = ProcList(NULL, 0);
+    int n = ProcList(procs, MAX_PROCS);
+    TracePrintf(0, "===proctest=== processes listed (expect %d) %d\n", total, n);
+    TracePrintf(0, "===proctest=== self is running (expect %d) %d\n", PROC_RUNNING, find(n, self)->state);
+    TracePrintf(0, "===proctest=== exited child (expect %d) %d\n", PROC_ZOMBIE, find(n, children[0])->state);
+    int sleeping = 0;
+    int parented = 0;
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        ProcInfo_t *child = find(n, children[i]);
+        if (child != NULL && child->ppid == self) {
+            parented++;
+        }
+        if (child != NULL && child->state == PROC_SLEEPING) {
+            sleeping++;
+        }
+    }
+    TracePrintf(0, "===proctest=== children of self (expect %d) %d\n", NUM_CHILDREN, parented);
+    TracePrintf(0, "===proctest=== children sleeping (expect %d) %d\n", NUM_CHILDREN - 1, sleeping);
+
+    TracePrintf(0, "===proctest=== short buffer (expect 1) %d\n", ProcList(procs, 1));
+    TracePrintf(0, "===proctest=== negative max (expect %d) %d\n", ERROR, ProcList(procs, -1));
+
+    // a collected child is gone from the table
+    int status;
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        Wait(&status);
+    }
+    n = ProcList(procs, MAX_PROCS);
+    TracePrintf(0, "===proctest=== after wait (expect %d) %d\n", total - NUM_CHILDREN, n);
+    TracePrintf(0, "===proctest=== collected child listed (expect 0) %d\n", find(n, children[0]) != NULL);
+    Exit(0);
+}
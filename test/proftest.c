@@ -0,0 +1,40 @@
+/*
+ proftest.c
+ A workload for the sampling profiler, spending about three times as long in
+ heavy() as in light(), both called from work()
+ Run with "./yalnix profile=1 profile_depth=4 test/proftest"; the profile printed
+ when it exits should show heavy well ahead of light in self samples, and work
+ and main with the most total samples
+*/
+
+#include <yuser.h>
+
+#define ROUNDS 20
+#define LIGHT_SPINS 200000
+
+volatile int sink;
+
+void light() {
+    for (int i = 0; i < LIGHT_SPINS; i++) {
+        sink += i;
+    }
+}
+
+void heavy() {
+    for (int i = 0; i < 3 * LIGHT_SPINS; i++) {
+        sink += i;
+    }
+}
+
+void work() {
+    light();
+    heavy();
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 0; i < ROUNDS; i++) {
+        work();
+    }
+    TracePrintf(0, "===proftest=== done\n");
+    Exit(0);
+}
@@ -0,0 +1,43 @@
+/*
+ quantumtest.c
+ Checks that SetQuantum accepts the caller and its children and rejects everything else,
+ and that batch children with long quanta still run to completion
+ Run with e.g. "./yalnix quantum=4 test/quantumtest" to change the default quantum
+*/
+
+#include <yuser.h>
+#include <custom_syscalls.h>
+
+#define NUM_CHILDREN 3
+#define BATCH_QUANTUM 20
+#define CHILD_LOOPS 20000000
+
+int main(int argc, char *argv[]) {
+    TracePrintf(0, "===quantumtest=== own quantum (expect 0) %d\n", SetQuantum(0, 5));
+    TracePrintf(0, "===quantumtest=== own pid (expect 0) %d\n", SetQuantum(GetPid(), 5));
+    TracePrintf(0, "===quantumtest=== zero ticks (expect %d) %d\n", ERROR, SetQuantum(0, 0));
+    TracePrintf(0, "===quantumtest=== too many ticks (expect %d) %d\n", ERROR, SetQuantum(0, MAX_QUANTUM_TICKS + 1));
+    TracePrintf(0, "===quantumtest=== not a child (expect %d) %d\n", ERROR, SetQuantum(GetPid() + 1000, 5));
+
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            volatile int sum = 0;
+            for (int j = 0; j < CHILD_LOOPS; j++) {
+                sum += j;
+            }
+            Exit(i);
+        }
+        TracePrintf(0, "===quantumtest=== child quantum (expect 0) %d\n", SetQuantum(pid, BATCH_QUANTUM));
+    }
+
+    int done = 0;
+    int status;
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        if (Wait(&status) != ERROR) {
+            done++;
+        }
+    }
+    TracePrintf(0, "===quantumtest=== children reaped (expect %d) %d\n", NUM_CHILDREN, done);
+    Exit(0);
+}
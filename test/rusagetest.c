@@ -0,0 +1,56 @@
+/*
+ rusagetest.c
+ Checks that GetRusage counts the syscalls, page faults and frames of the caller,
+ and hands back what a child used once it has been collected with Wait
+*/
+
+#include <yuser.h>
+#include <custom_syscalls.h>
+
+#define NUM_GETPIDS 10
+#define NUM_DELAYS 3
+#define TOUCH_PAGES 8
+#define CHILD_STATUS 7
+
+Rusage_t before;
+Rusage_t after;
+
+int main(int argc, char *argv[]) {
+    GetRusage(0, &before);
+    for (int i = 0; i < NUM_GETPIDS; i++) {
+        GetPid();
+    }
+    GetRusage(0, &after);
+    TracePrintf(0, "===rusagetest=== getpid calls (expect %d) %d\n", NUM_GETPIDS,
+                after.syscalls_by_number[YALNIX_GETPID] - before.syscalls_by_number[YALNIX_GETPID]);
+    // the second GetRusage and the GetPids are counted
+    TracePrintf(0, "===rusagetest=== all syscalls (expect %d) %d\n", NUM_GETPIDS + 1, after.syscalls - before.syscalls);
+
+    // every page of a fresh heap buffer faults in and then holds a frame
+    char *buf = malloc(TOUCH_PAGES * PAGESIZE);
+    GetRusage(0, &before);
+    for (int i = 0; i < TOUCH_PAGES; i++) {
+        buf[i * PAGESIZE] = 1;
+    }
+    GetRusage(0, &after);
+    TracePrintf(0, "===rusagetest=== faulted touching pages (expect 1) %d\n", after.page_faults - before.page_faults >= TOUCH_PAGES);
+    TracePrintf(0, "===rusagetest=== frames gained (expect 1) %d\n", after.frames - before.frames >= TOUCH_PAGES);
+
+    int pid = Fork();
+    if (pid == 0) {
+        for (int i = 0; i < NUM_DELAYS; i++) {
+            Delay(1);
+        }
+        Exit(CHILD_STATUS);
+    }
+    TracePrintf(0, "===rusagetest=== running child (expect 0) %d\n", GetRusage(pid, &after));
+    int status;
+    Wait(&status);
+    GetRusage(RUSAGE_WAITED, &after);
+    TracePrintf(0, "===rusagetest=== child delays (expect %d) %d\n", NUM_DELAYS, after.syscalls_by_number[YALNIX_DELAY]);
+    TracePrintf(0, "===rusagetest=== child slept (expect 1) %d\n", after.voluntary_switches >= NUM_DELAYS);
+    GetRusage(RUSAGE_CHILDREN, &after);
+    TracePrintf(0, "===rusagetest=== children delays (expect %d) %d\n", NUM_DELAYS, after.syscalls_by_number[YALNIX_DELAY]);
+    TracePrintf(0, "===rusagetest=== collected child (expect %d) %d\n", ERROR, GetRusage(pid, &after));
+    Exit(0);
+}
@@ -0,0 +1,49 @@
+/*
+ schedtest.c
+ Runs CPU hogs of equal length but unequal tickets to completion so that scheduling policies can be compared
+ Run with e.g. "./yalnix sched=stride test/schedtest", or sched=rr or sched=mlfq
+ Under stride hog i holds (i + 1) * TICKET_UNIT tickets, so the hogs should finish in
+ the order of their tickets, most first, while rr and mlfq ignore tickets and finish them close together
+*/
+
+#include <yuser.h>
+#include <custom_syscalls.h>
+
+#define NUM_HOGS 4
+#define HOG_LOOPS 20000000
+#define TICKET_UNIT 100
+
+int main(int argc, char *argv[]) {
+    for (int i = 0; i < NUM_HOGS; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            SetTickets(0, (i + 1) * TICKET_UNIT);
+            volatile int sum = 0;
+            for (int j = 0; j < HOG_LOOPS; j++) {
+                sum += j;
+            }
+            Exit(i);
+        }
+    }
+
+    TracePrintf(0, "===schedtest=== too many tickets (expect %d) %d\n", ERROR, SetTickets(0, MAX_TICKETS + 1));
+    TracePrintf(0, "===schedtest=== no tickets (expect %d) %d\n", ERROR, SetTickets(0, 0));
+
+    int done = 0;
+    int in_order = 0;
+    int status;
+    for (int i = 0; i < NUM_HOGS; i++) {
+        int pid = Wait(&status);
+        if (pid != ERROR) {
+            TracePrintf(0, "===schedtest=== hog %d (pid %d, %d tickets) finished %d\n", status, pid,
+                        (status + 1) * TICKET_UNIT, done);
+            if (status == NUM_HOGS - 1 - done) {
+                in_order++;
+            }
+            done++;
+        }
+    }
+    TracePrintf(0, "===schedtest=== hogs reaped (expect %d) %d\n", NUM_HOGS, done);
+    TracePrintf(0, "===schedtest=== finished in ticket order (expect %d under stride) %d\n", NUM_HOGS, in_order);
+    Exit(0);
+}
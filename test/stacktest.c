@@ -0,0 +1,41 @@
+/*
+ stacktest.c
+ Checks that a deep chain of calls grows the stack on demand, and that a wild
+ pointer into the gap far below the stack kills the process instead of growing it
+ Run with e.g. "./yalnix stack_prefault=8 test/stacktest" to change how many pages each growth maps
+*/
+
+#include <yuser.h>
+
+#define DEPTH 1000
+
+// how far below the stack pointer the wild write lands
+#define WILD_OFFSET (32 * PAGESIZE)
+
+// each call keeps a small buffer live on the stack, so the chain covers many pages
+int Recurse(int depth) {
+    int buffer[50];
+    buffer[0] = depth;
+    buffer[49] = depth + 1;
+    if (depth == 0) {
+        return 0;
+    }
+    int below = Recurse(depth - 1);
+    return below + (buffer[49] - buffer[0]);
+}
+
+int main(int argc, char *argv[]) {
+    int result = Recurse(DEPTH);
+    TracePrintf(0, "===stacktest=== (expect %d) %d\n", DEPTH, result);
+
+    if (Fork() == 0) {
+        char here;
+        char *wild = &here - WILD_OFFSET;
+        *wild = 1;
+        Exit(0);
+    }
+    int status;
+    Wait(&status);
+    TracePrintf(0, "===stacktest=== wild write below the stack (expect %d) %d\n", ERROR, status);
+    Exit(0);
+}
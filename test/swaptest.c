@@ -0,0 +1,57 @@
+/*
+ swaptest.c
+ Checks that several processes whose heaps together are larger than physical memory
+ keep their contents once pages are swapped out and read back in
+*/
+
+#include <yuser.h>
+
+#define PAGE_BYTES 8192
+#define NUM_CHILDREN 8
+#define NUM_PAGES 96
+
+int main(int argc, char *argv[]) {
+    int num_children = NUM_CHILDREN;
+    int num_pages = NUM_PAGES;
+
+    for (int i = 0; i < num_children; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            int *heap = malloc(num_pages * PAGE_BYTES);
+            if (heap == NULL) {
+                TracePrintf(0, "===swaptest=== CHILD %d: malloc failed\n", i);
+                Exit(-1);
+            }
+
+            // stamp every page with something only this child would write there
+            int words = PAGE_BYTES / sizeof(int);
+            for (int page = 0; page < num_pages; page++) {
+                heap[page * words] = i * 100000 + page;
+                heap[page * words + words - 1] = page;
+            }
+
+            // let the other children run and push these pages out
+            Delay(5);
+
+            int errors = 0;
+            for (int page = 0; page < num_pages; page++) {
+                if (heap[page * words] != i * 100000 + page || heap[page * words + words - 1] != page) {
+                    errors++;
+                }
+            }
+            TracePrintf(0, "===swaptest=== CHILD %d: (expect 0) %d bad pages\n", i, errors);
+            Exit(errors);
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < num_children; i++) {
+        int status;
+        Wait(&status);
+        if (status != 0) {
+            failed++;
+        }
+    }
+    TracePrintf(0, "===swaptest=== PARENT: (expect 0) %d children saw bad pages\n", failed);
+    Exit(0);
+}
@@ -0,0 +1,61 @@
+/*
+ waittest.c
+ Checks that Wait collects every exited child exactly once, that a child's
+ own children are not collected by its parent once it exits, and that many
+ short lived children can be forked and collected one after another
+*/
+
+#include <yuser.h>
+
+#define NUM_CHILDREN 16
+#define NUM_ROUNDS 200
+#define ORPHAN_DELAY 5
+#define ORPHAN_STATUS 42
+
+int main(int argc, char *argv[]) {
+    // children exit with 1..NUM_CHILDREN, in whatever order they get to run
+    for (int i = 1; i <= NUM_CHILDREN; i++) {
+        if (Fork() == 0) {
+            Exit(i);
+        }
+    }
+    int sum = 0;
+    int collected = 0;
+    int status;
+    for (int i = 0; i < NUM_CHILDREN; i++) {
+        if (Wait(&status) != ERROR) {
+            collected++;
+            sum += status;
+        }
+    }
+    TracePrintf(0, "===waittest=== children collected (expect %d) %d\n", NUM_CHILDREN, collected);
+    TracePrintf(0, "===waittest=== sum of statuses (expect %d) %d\n", NUM_CHILDREN * (NUM_CHILDREN + 1) / 2, sum);
+    TracePrintf(0, "===waittest=== wait with none left (expect %d) %d\n", ERROR, Wait(&status));
+
+    // the grandchild outlives its parent and is adopted by init, so only the child is collected here
+    int child = Fork();
+    if (child == 0) {
+        if (Fork() == 0) {
+            Delay(ORPHAN_DELAY);
+            Exit(0);
+        }
+        Exit(ORPHAN_STATUS);
+    }
+    TracePrintf(0, "===waittest=== orphaning child (expect %d) %d\n", child, Wait(&status));
+    TracePrintf(0, "===waittest=== orphaning child status (expect %d) %d\n", ORPHAN_STATUS, status);
+    TracePrintf(0, "===waittest=== orphan not collected (expect %d) %d\n", ERROR, Wait(&status));
+
+    // every exited child is freed once collected, so this needs no more memory than a single round
+    int rounds = 0;
+    for (int i = 0; i < NUM_ROUNDS; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            Exit(i);
+        }
+        if (Wait(&status) == pid && status == i) {
+            rounds++;
+        }
+    }
+    TracePrintf(0, "===waittest=== fork and wait rounds (expect %d) %d\n", NUM_ROUNDS, rounds);
+    Exit(0);
+}
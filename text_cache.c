@@ -0,0 +1,98 @@
+// Contains the kernel cache of text segments shared by processes running the same executable
+//
+// Andrew Chen
+// 10/2026
+
+#include <unistd.h>
+#include <ykernel.h>
+#include <frame_manager.h>
+#include <text_cache.h>
+
+// singly linked list of cached text images
+TextImage_t *text_images = NULL;
+
+// finds the cached image of the executable at name whose file has the identity in st
+// returns NULL if no running process has loaded it
+TextImage_t *FindTextImage(char *name, struct stat *st) {
+  for (TextImage_t *image = text_images; image != NULL; image = image->next) {
+    if (image->dev == st->st_dev && image->ino == st->st_ino &&
+        image->mtime == st->st_mtime && image->size == st->st_size &&
+        strcmp(image->name, name) == 0) {
+      return image;
+    }
+  }
+  return NULL;
+}
+
+// caches the executable open at fd, taking ownership of fd
+// its text pages are filled in as processes touch them, and it starts with no users
+TextImage_t *CreateTextImage(char *name, struct stat *st, int fd, int t_npg) {
+  TextImage_t *image = malloc(sizeof(TextImage_t));
+  if (image == NULL) {
+    TracePrintf(1, "CreateTextImage: failed to malloc image\n");
+    return NULL;
+  }
+  image->name = malloc(strlen(name) + 1);
+  image->pfns = malloc(t_npg * sizeof(int));
+  if (image->name == NULL || image->pfns == NULL) {
+    TracePrintf(1, "CreateTextImage: failed to malloc image contents\n");
+    free(image->name);
+    free(image->pfns);
+    free(image);
+    return NULL;
+  }
+  strcpy(image->name, name);
+  image->dev = st->st_dev;
+  image->ino = st->st_ino;
+  image->mtime = st->st_mtime;
+  image->size = st->st_size;
+  image->fd = fd;
+  image->t_npg = t_npg;
+  for (int i = 0; i < t_npg; i++) {
+    image->pfns[i] = -1;
+  }
+  image->users = 0;
+  image->symbols = NULL;
+  image->num_symbols = -1;
+  image->next = text_images;
+  text_images = image;
+  return image;
+}
+
+// adds a process to the users of a text image
+void RetainTextImage(TextImage_t *image) {
+  if (image != NULL) {
+    image->users++;
+  }
+}
+
+// removes a process from the users of a text image, dropping the image once nothing maps it
+void ReleaseTextImage(TextImage_t *image) {
+  if (image == NULL) {
+    return;
+  }
+  image->users--;
+  if (image->users > 0) {
+    return;
+  }
+
+  // unlink the image and drop the cache's reference to each text frame
+  TextImage_t **prev = &text_images;
+  while (*prev != image) {
+    prev = &(*prev)->next;
+  }
+  *prev = image->next;
+  for (int i = 0; i < image->t_npg; i++) {
+    if (image->pfns[i] != -1) {
+      ReleaseFrame(image->pfns[i]);
+    }
+  }
+  close(image->fd);
+  for (int i = 0; i < image->num_symbols; i++) {
+    free(image->symbols[i].name);
+  }
+  free(image->symbols);
+  free(image->pfns);
+  free(image->name);
+  free(image);
+}
@@ -0,0 +1,54 @@
+// Contains the kernel cache of text segments shared by processes running the same executable
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _text_cache_h
+#define _text_cache_h
+
+#include <sys/stat.h>
+#include <ykernel.h>
+
+// a function in the symbol table of an executable
+struct Symbol {
+  unsigned int addr;
+  unsigned int size;
+  char *name;
+};
+
+typedef struct Symbol Symbol_t;
+
+// text segment of one executable, shared read only by every process running it
+// its open file also backs the text and data pages that those processes load on first touch
+struct TextImage {
+  char *name;               // path the executable was loaded from
+  dev_t dev;                // identity of the file the text was read from
+  ino_t ino;
+  time_t mtime;
+  off_t size;
+  int fd;                   // executable file, open for as long as the image is cached
+  int t_npg;                // number of text pages
+  int *pfns;                // frame holding each text page, -1 until first touched, each retained once by the cache
+  int users;                // number of processes currently mapping this text
+  Symbol_t *symbols;        // functions of the executable sorted by address, read the first time a profile is printed, see profiler.c
+  int num_symbols;          // number of entries in symbols, -1 until they are read
+  struct TextImage *next;
+};
+
+typedef struct TextImage TextImage_t;
+
+// finds the cached image of the executable at name whose file has the identity in st
+// returns NULL if no running process has loaded it
+TextImage_t *FindTextImage(char *name, struct stat *st);
+
+// caches the executable open at fd, taking ownership of fd
+// its text pages are filled in as processes touch them, and it starts with no users
+TextImage_t *CreateTextImage(char *name, struct stat *st, int fd, int t_npg);
+
+// adds a process to the users of a text image
+void RetainTextImage(TextImage_t *image);
+
+// removes a process from the users of a text image, dropping the image once nothing maps it
+void ReleaseTextImage(TextImage_t *image);
+
+#endif
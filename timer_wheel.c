@@ -0,0 +1,37 @@
+// Contains the timing wheel that holds processes sleeping in Delay until the tick they wake up on
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <timer_wheel.h>
+
+// clock ticks since boot
+unsigned int clock_ticks_now = 0;
+
+// sleeping processes in each slot, linked through timer_next and sorted by wake_tick,
+// with processes waking on the same tick in the order they went to sleep
+pcb_t *timer_wheel[TIMER_WHEEL_SLOTS];
+
+// puts a process to sleep until clock tick pcb->wake_tick
+void TimerWheelAdd(pcb_t *pcb) {
+  pcb_t **link = &timer_wheel[pcb->wake_tick & (TIMER_WHEEL_SLOTS - 1)];
+  while (*link != NULL && (*link)->wake_tick <= pcb->wake_tick) {
+    link = &(*link)->timer_next;
+  }
+  pcb->timer_next = *link;
+  *link = pcb;
+}
+
+// advances the clock by one tick and hands each process due to wake up on it to wake
+void TimerWheelTick(int (*wake)(pcb_t *pcb)) {
+  clock_ticks_now++;
+  pcb_t **slot = &timer_wheel[clock_ticks_now & (TIMER_WHEEL_SLOTS - 1)];
+  while (*slot != NULL && (*slot)->wake_tick <= clock_ticks_now) {
+    pcb_t *pcb = *slot;
+    *slot = pcb->timer_next;
+    pcb->timer_next = NULL;
+    pcb->wake_tick = 0;
+    wake(pcb);
+  }
+}
@@ -0,0 +1,27 @@
+// Contains the timing wheel that holds processes sleeping in Delay until the tick they wake up on
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _timer_wheel_h
+#define _timer_wheel_h
+
+#include <ykernel.h>
+#include <pcb.h>
+
+// number of slots in the wheel, a power of two
+// a process waking up on tick t sits in slot t % TIMER_WHEEL_SLOTS, so sleeps longer than one
+// turn of the wheel share a slot with shorter ones and wait there for later turns
+#define TIMER_WHEEL_SLOTS 256
+
+// clock ticks since boot
+extern unsigned int clock_ticks_now;
+
+// puts a process to sleep until clock tick pcb->wake_tick
+void TimerWheelAdd(pcb_t *pcb);
+
+// advances the clock by one tick and hands each process due to wake up on it to wake
+// only the processes in the slot for this tick are looked at, and only up to the first one due on a later turn
+void TimerWheelTick(int (*wake)(pcb_t *pcb));
+
+#endif
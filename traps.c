@@ -9,6 +9,14 @@
 #include <process_controller.h>
 #include <synchronize_syscalls.h>
 #include <io_syscalls.h>
+#include <page_fault.h>
+#include <frame_manager.h>
+#include <swap.h>
+#include <dedup.h>
+#include <scheduler.h>
+#include <custom_syscalls.h>
+#include <profiler.h>
+#include <timer_wheel.h>
 
 // Unknown trap was thrown
 void
@@ -26,6 +34,7 @@ TrapKernel(UserContext *uc)
   // Makes the corresponding syscall to the syscall_number (see syscalls section)
 
   int syscall_number = uc->code;
+  curr_pcb->user_sp = uc->sp;
   int rc;
   int pid;
   int len;
@@ -37,6 +46,11 @@ TrapKernel(UserContext *uc)
 
   TracePrintf(1,"Syscall Code: %x\n", syscall_number);
 
+  curr_pcb->rusage.syscalls++;
+  if (syscall_number >= 0 && syscall_number < RUSAGE_SYSCALLS) {
+    curr_pcb->rusage.syscalls_by_number[syscall_number]++;
+  }
+
   switch(syscall_number) {
     case YALNIX_FORK:
       TracePrintf(1,"KernelFork()\n");
@@ -53,6 +67,12 @@ TrapKernel(UserContext *uc)
       // figure out the path & argvec
       char* filename = (char*)(uc->regs[0]);
       char** argvec = (char**)(uc->regs[1]);
+      // the kernel reads the filename and arguments, so they must be resident
+      if (PrepareUserString(filename) == -1 || PrepareUserArgv(argvec) == -1) {
+        TracePrintf(1, "--- TRAP KERNEL --- exec arguments are not readable\n");
+        uc->regs[0] = ERROR;
+        break;
+      }
       TracePrintf(1, "--- TRAP KERNEL --- filename: %s\n", filename);
       TracePrintf(1, "--- TRAP KERNEL --- argv: %s\n", argvec);
 
@@ -77,15 +97,8 @@ TrapKernel(UserContext *uc)
     case YALNIX_WAIT:
       TracePrintf(1,"KernelWait()\n");
       int* status_ptr = (int *) (uc->regs[0]);
-      rc = KernelWait(status_ptr);
-      if (rc == 0) {
-        SwitchPCB(uc, 2, NULL);   
-        if (status_ptr != NULL) {
-          *status_ptr = uc->regs[1];
-        }
-      } else {
-        uc->regs[0] = rc;
-      }
+      rc = KernelWait(status_ptr, uc);
+      uc->regs[0] = rc;
       break;
     case YALNIX_GETPID:
       TracePrintf(1,"KernelGetPid()\n");
@@ -104,7 +117,7 @@ TrapKernel(UserContext *uc)
       rc = KernelDelay(clock_ticks);
       uc->regs[0] = rc;
       if (rc == 0) {
-        SwitchPCB(uc, 1, NULL);
+        SwitchPCB(uc, SWITCH_REQUEUE, NULL);
       }
       break;
       
@@ -202,6 +215,44 @@ TrapKernel(UserContext *uc)
       rc = KernelPipeWrite(pipe_id, buf, len);
       uc->regs[0] = rc;
       break;
+    case YALNIX_RECLAIM:
+      int id = uc->regs[0];
+      TracePrintf(1,"KernelReclaim(id %d)\n", id);
+      rc = KernelReclaim(id);
+      uc->regs[0] = rc;
+      break;
+    case YALNIX_SET_QUANTUM:
+      pid = uc->regs[0];
+      int ticks = uc->regs[1];
+      TracePrintf(1,"KernelSetQuantum(pid %d, ticks %d)\n", pid, ticks);
+      rc = KernelSetQuantum(pid, ticks);
+      uc->regs[0] = rc;
+      break;
+    case YALNIX_SET_TICKETS:
+      pid = uc->regs[0];
+      int tickets = uc->regs[1];
+      TracePrintf(1,"KernelSetTickets(pid %d, tickets %d)\n", pid, tickets);
+      rc = KernelSetTickets(pid, tickets);
+      uc->regs[0] = rc;
+      break;
+    case YALNIX_PROC_INFO:
+      // ProcList and GetRusage share this number, and say which they are in the first argument
+      if (uc->regs[0] == PROC_INFO_LIST) {
+        ProcInfo_t *procs = (ProcInfo_t *) uc->regs[1];
+        int max = uc->regs[2];
+        TracePrintf(1,"KernelProcList(buf %x, max %d)\n", procs, max);
+        rc = KernelProcList(procs, max);
+      } else if (uc->regs[0] == PROC_INFO_RUSAGE) {
+        int who = uc->regs[1];
+        Rusage_t *rusage = (Rusage_t *) uc->regs[2];
+        TracePrintf(1,"KernelGetRusage(who %d, buf %x)\n", who, rusage);
+        rc = KernelGetRusage(who, rusage);
+      } else {
+        TracePrintf(1,"KernelProcInfo: unknown call %d\n", uc->regs[0]);
+        rc = ERROR;
+      }
+      uc->regs[0] = rc;
+      break;
   }
 }
 
@@ -210,8 +261,29 @@ void
 TrapClock(UserContext *uc)
 {
   TracePrintf(1,"Clock Trap\n");
+  curr_pcb->rusage.ticks++;
+  ProfileTick(curr_pcb, uc);
+
+  // a tick that interrupted the idle process is spare time, so spend it zeroing free frames
+  if (curr_pcb == idle_pcb) {
+    RefillZeroedFrames(ZEROED_FRAMES_PER_TICK);
+  }
+
+  // under memory pressure, move the swap clock hand along to find pages that are no longer used
+  SampleColdPages();
+
+  // look for identical pages to merge, every few ticks while a process runs and further on every tick with nothing else to do
+  if (curr_pcb == idle_pcb) {
+    ScanForDuplicates(DEDUP_IDLE_SCAN_PAGES);
+  } else if (clock_ticks_now % DEDUP_BUSY_INTERVAL == 0) {
+    ScanForDuplicates(DEDUP_SCAN_PAGES);
+  }
   TickDelayedPCBs();
-  SwitchPCB(uc, 1, NULL);
+
+  // only switch once the scheduling policy decides the running process has had its turn
+  if (SchedTick(curr_pcb)) {
+    SwitchPCB(uc, SWITCH_REQUEUE, NULL);
+  }
 }
 
 // This trap goes off on an illegal operatoin
@@ -232,23 +304,19 @@ void
 TrapMemory(UserContext *uc)
 {
   TracePrintf(1,"Memory Trap\n");
+  curr_pcb->rusage.page_faults++;
+  curr_pcb->user_sp = uc->sp;
 
-  // check if addr is above the brk + 1 page (for red zone)
-  if (uc->addr <= (curr_pcb->brk + PAGESIZE)) {
-    TracePrintf(1,"TrapMemory: addr not above brk + 1 page (for red zone)\n");
-    // abort the process
-    KernelExit(uc, -1);
+  // a page of the executable, heap or stack touched for the first time is mapped in,
+  // a fault just below the stack grows it, and a write to a copy-on-write page only needs a private copy of that page
+  if (ResolvePageFault(uc->addr) == 0) {
+    return;
   }
 
-  // check if addr is below the sp
-  if (uc->addr >= curr_pcb->uc.sp) {
-    TracePrintf(1,"TrapMemory: addr not below sp\n");
-    // abort the process
-    KernelExit(uc, -1);
-  }
-  
-  // otherwise enlarge the stack to cover addr
-  curr_pcb->uc.sp = uc->addr;
+  // anything else is outside the process's areas, in the red zone between heap and stack, or past the stack limit
+  TracePrintf(0,"TrapMemory: pid %d touched unmapped address %x\n", curr_pcb->pid, uc->addr);
+  // abort the process
+  KernelExit(uc, -1);
 }
 
 // This trap occurs whenever there's an illegal
@@ -0,0 +1,97 @@
+// Contains the sorted list of virtual memory areas that make up a process's region 1
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <vma.h>
+
+// inserts a new area into a list sorted by start
+// returns NULL if it would overlap an existing area or could not be allocated
+VMA_t *AddVMA(VMA_t **vmas, int kind, int start, int end, int prot) {
+  if (start > end || start < 0 || end > MAX_PT_LEN) {
+    TracePrintf(1, "AddVMA: invalid range %d to %d\n", start, end);
+    return NULL;
+  }
+
+  // find the areas the new one goes between, checking it fits
+  VMA_t *prev = NULL;
+  VMA_t *next = *vmas;
+  while (next != NULL && next->start < start) {
+    prev = next;
+    next = next->next;
+  }
+  if ((prev != NULL && prev->end > start) || (next != NULL && next->start < end)) {
+    TracePrintf(1, "AddVMA: range %d to %d overlaps an existing area\n", start, end);
+    return NULL;
+  }
+
+  VMA_t *vma = malloc(sizeof(VMA_t));
+  if (vma == NULL) {
+    TracePrintf(1, "AddVMA: failed to malloc vma\n");
+    return NULL;
+  }
+  bzero(vma, sizeof(VMA_t));
+  vma->kind = kind;
+  vma->start = start;
+  vma->end = end;
+  vma->prot = prot;
+  vma->next = next;
+  if (prev == NULL) {
+    *vmas = vma;
+  } else {
+    prev->next = vma;
+  }
+  return vma;
+}
+
+// returns the area containing a region 1 page, or NULL if the page is not mapped
+VMA_t *FindVMA(VMA_t *vmas, int page) {
+  for (VMA_t *vma = vmas; vma != NULL && vma->start <= page; vma = vma->next) {
+    if (page < vma->end) {
+      return vma;
+    }
+  }
+  return NULL;
+}
+
+// returns the first area of a kind, or NULL if there is none
+VMA_t *FindVMAKind(VMA_t *vmas, int kind) {
+  for (VMA_t *vma = vmas; vma != NULL; vma = vma->next) {
+    if (vma->kind == kind) {
+      return vma;
+    }
+  }
+  return NULL;
+}
+
+// copies every area of a list into a new list
+// returns -1 and leaves *dst empty if an area could not be allocated
+int CopyVMAs(VMA_t **dst, VMA_t *src) {
+  *dst = NULL;
+  VMA_t **link = dst;
+  for (VMA_t *vma = src; vma != NULL; vma = vma->next) {
+    VMA_t *copy = malloc(sizeof(VMA_t));
+    if (copy == NULL) {
+      TracePrintf(1, "CopyVMAs: failed to malloc vma\n");
+      FreeVMAs(dst);
+      return -1;
+    }
+    *copy = *vma;
+    copy->next = NULL;
+    *link = copy;
+    link = &copy->next;
+  }
+  return 0;
+}
+
+// frees every area of a list and leaves it empty
+void FreeVMAs(VMA_t **vmas) {
+  VMA_t *vma = *vmas;
+  while (vma != NULL) {
+    VMA_t *next = vma->next;
+    free(vma);
+    vma = next;
+  }
+  *vmas = NULL;
+}
@@ -0,0 +1,49 @@
+// Contains the sorted list of virtual memory areas that make up a process's region 1
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _vma_h
+#define _vma_h
+
+#include <ykernel.h>
+
+// kinds of virtual memory area
+#define VMA_TEXT 0        // read only program text, loaded from the executable and shared through its TextImage
+#define VMA_DATA 1        // initialized data loaded from the executable, followed by zero filled bss
+#define VMA_HEAP 2        // zero filled pages up to the brk
+#define VMA_STACK 3       // zero filled pages at the top of region 1
+
+// a run of region 1 pages [start, end) mapped the same way
+// every valid page table entry of a process lies inside one of its areas
+struct VMA {
+  int kind;                 // one of the VMA_ kinds above
+  int start;                // first region 1 page
+  int end;                  // one past the last region 1 page
+  int prot;                 // protection the pages are mapped with
+  long faddr;               // file offset of the first page, for areas backed by the executable
+  int file_npg;             // number of pages read from the file, the rest are zero filled
+  void *zero_from;          // bytes at or past this address within the file pages are zero filled, NULL if none
+  struct VMA *next;         // next area, in order of increasing start
+};
+
+typedef struct VMA VMA_t;
+
+// inserts a new area into a list sorted by start
+// returns NULL if it would overlap an existing area or could not be allocated
+VMA_t *AddVMA(VMA_t **vmas, int kind, int start, int end, int prot);
+
+// returns the area containing a region 1 page, or NULL if the page is not mapped
+VMA_t *FindVMA(VMA_t *vmas, int page);
+
+// returns the first area of a kind, or NULL if there is none
+VMA_t *FindVMAKind(VMA_t *vmas, int kind);
+
+// copies every area of a list into a new list
+// returns -1 and leaves *dst empty if an area could not be allocated
+int CopyVMAs(VMA_t **dst, VMA_t *src);
+
+// frees every area of a list and leaves it empty
+void FreeVMAs(VMA_t **vmas);
+
+#endif
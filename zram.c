@@ -0,0 +1,234 @@
+// Contains a compressed in-memory store for user pages evicted under memory pressure
+//
+// Andrew Chen
+// 10/2026
+
+#include <ykernel.h>
+#include <zram.h>
+#include <frame_manager.h>
+
+// pages are compressed with PackBits run length encoding, which is cheap and suits the long
+// runs of zeros and repeated words in stacks, heaps and bss
+// each header byte h is followed by h + 1 literal bytes if h >= 0, or by one byte repeated 1 - h times if h < 0
+#define ZRAM_MAX_RUN 128
+
+// pages of arena to allocate at boot, set by the zram_pages boot option
+int zram_arena_pages = ZRAM_DEFAULT_PAGES;
+
+// number of chunks in the arena, and of entries, since each page stored takes at least one chunk
+int zram_chunks = 0;
+
+// compressed entries, indexed by the entry number stored in a swapped out page table entry
+ZramEntry_t *zram_entries = NULL;
+
+// stack of free entries
+int *zram_free_entries = NULL;
+int num_zram_free_entries = 0;
+
+// arena holding the compressed bytes, and the chunk following each chunk of an entry, -1 after its last
+unsigned char *zram_arena = NULL;
+int *zram_chunk_next = NULL;
+
+// stack of free chunks
+int *zram_free_chunks = NULL;
+int num_zram_free_chunks = 0;
+
+// buffer pages are compressed into before they are copied into chunks, and gathered into before they are decompressed
+unsigned char zram_buffer[PAGESIZE + PAGESIZE / ZRAM_MAX_RUN + 1];
+
+// number of pages stored, pages that did not compress well enough, and pages loaded back
+int num_zram_stores = 0;
+int num_zram_rejects = 0;
+int num_zram_loads = 0;
+
+// uncompressed and compressed bytes of every page stored, for the compression ratio
+long zram_bytes_in = 0;
+long zram_bytes_out = 0;
+
+// compressed bytes currently held by the store
+long zram_bytes_used = 0;
+
+// compresses a page into dst, stopping once more than max bytes would be needed
+// returns the compressed length, or -1 if it is more than max
+int ZramCompress(unsigned char *src, unsigned char *dst, int max) {
+  int in = 0;
+  int out = 0;
+  while (in < PAGESIZE) {
+    // a run of at least 3 equal bytes is stored as a header and one byte
+    int run = 1;
+    while (in + run < PAGESIZE && run < ZRAM_MAX_RUN && src[in + run] == src[in]) {
+      run++;
+    }
+    if (run >= 3) {
+      if (out + 2 > max) {
+        return -1;
+      }
+      dst[out++] = (unsigned char) (1 - run);
+      dst[out++] = src[in];
+      in += run;
+      continue;
+    }
+
+    // anything else is stored literally up to the start of the next run
+    int start = in;
+    while (in < PAGESIZE && in - start < ZRAM_MAX_RUN) {
+      if (in + 2 < PAGESIZE && src[in] == src[in + 1] && src[in] == src[in + 2]) {
+        break;
+      }
+      in++;
+    }
+    int n = in - start;
+    if (out + 1 + n > max) {
+      return -1;
+    }
+    dst[out++] = (unsigned char) (n - 1);
+    memcpy(dst + out, src + start, n);
+    out += n;
+  }
+  return out;
+}
+
+// decompresses len bytes of src into a page at dst
+// returns -1 if the data does not decompress to exactly one page
+int ZramDecompress(unsigned char *src, int len, unsigned char *dst) {
+  int in = 0;
+  int out = 0;
+  while (in < len) {
+    int header = (signed char) src[in++];
+    if (header >= 0) {
+      int n = header + 1;
+      if (in + n > len || out + n > PAGESIZE) {
+        return -1;
+      }
+      memcpy(dst + out, src + in, n);
+      in += n;
+      out += n;
+    } else {
+      int n = 1 - header;
+      if (in >= len || out + n > PAGESIZE) {
+        return -1;
+      }
+      memset(dst + out, src[in++], n);
+      out += n;
+    }
+  }
+  return out == PAGESIZE ? 0 : -1;
+}
+
+// allocates the arena, returns -1 if it can't, in which case nothing is ever stored
+// this runs at boot, before any user page exists that a malloc could need to evict
+int InitZram() {
+  int max_pages = (num_frames - num_allocated_frames) / ZRAM_MAX_FREE_SHARE;
+  int pages = zram_arena_pages < max_pages ? zram_arena_pages : max_pages;
+  if (pages < zram_arena_pages) {
+    TracePrintf(0, "InitZram: limiting arena to %d of the %d pages asked for\n", pages, zram_arena_pages);
+  }
+  zram_chunks = pages * (PAGESIZE / ZRAM_CHUNK_SIZE);
+  if (zram_chunks == 0) {
+    TracePrintf(1, "InitZram: arena is empty\n");
+    return -1;
+  }
+
+  zram_arena = malloc(zram_chunks * ZRAM_CHUNK_SIZE);
+  zram_entries = malloc(zram_chunks * sizeof(ZramEntry_t));
+  zram_free_entries = malloc(zram_chunks * sizeof(int));
+  zram_chunk_next = malloc(zram_chunks * sizeof(int));
+  zram_free_chunks = malloc(zram_chunks * sizeof(int));
+  if (zram_arena == NULL || zram_entries == NULL || zram_free_entries == NULL ||
+      zram_chunk_next == NULL || zram_free_chunks == NULL) {
+    TracePrintf(1, "InitZram: failed to malloc %d page arena\n", pages);
+    free(zram_arena);
+    free(zram_entries);
+    free(zram_free_entries);
+    free(zram_chunk_next);
+    free(zram_free_chunks);
+    zram_arena = NULL;
+    zram_chunks = 0;
+    return -1;
+  }
+  for (int entry = zram_chunks - 1; entry >= 0; entry--) {
+    zram_entries[entry].chunk = -1;
+    zram_free_entries[num_zram_free_entries] = entry;
+    num_zram_free_entries++;
+  }
+  for (int chunk = zram_chunks - 1; chunk >= 0; chunk--) {
+    zram_free_chunks[num_zram_free_chunks] = chunk;
+    num_zram_free_chunks++;
+  }
+  return 0;
+}
+
+// compresses the page at addr into the store and returns its entry
+// returns -1 if the page does not compress well enough or the store is full
+int ZramStore(void *addr) {
+  if (num_zram_free_entries == 0) {
+    return -1;
+  }
+
+  int len = ZramCompress(addr, zram_buffer, ZRAM_MAX_COMPRESSED);
+  int chunks = (len + ZRAM_CHUNK_SIZE - 1) / ZRAM_CHUNK_SIZE;
+  if (len == -1 || chunks > num_zram_free_chunks) {
+    num_zram_rejects++;
+    return -1;
+  }
+
+  // copy the compressed bytes into a chain of free chunks, linked from the last one back to the first
+  int chunk = -1;
+  for (int i = chunks - 1; i >= 0; i--) {
+    num_zram_free_chunks--;
+    int prev = zram_free_chunks[num_zram_free_chunks];
+    int n = (i == chunks - 1) ? len - i * ZRAM_CHUNK_SIZE : ZRAM_CHUNK_SIZE;
+    memcpy(zram_arena + prev * ZRAM_CHUNK_SIZE, zram_buffer + i * ZRAM_CHUNK_SIZE, n);
+    zram_chunk_next[prev] = chunk;
+    chunk = prev;
+  }
+
+  num_zram_free_entries--;
+  int entry = zram_free_entries[num_zram_free_entries];
+  zram_entries[entry].chunk = chunk;
+  zram_entries[entry].len = len;
+  num_zram_stores++;
+  zram_bytes_in += PAGESIZE;
+  zram_bytes_out += len;
+  zram_bytes_used += len;
+  return entry;
+}
+
+// decompresses an entry into the page at addr and frees the entry
+int ZramLoad(int entry, void *addr) {
+  if (entry < 0 || entry >= zram_chunks || zram_entries[entry].chunk == -1) {
+    TracePrintf(1, "ZramLoad: entry %d is not in use\n", entry);
+    return -1;
+  }
+  int len = zram_entries[entry].len;
+  int off = 0;
+  for (int chunk = zram_entries[entry].chunk; chunk != -1; chunk = zram_chunk_next[chunk]) {
+    int n = len - off < ZRAM_CHUNK_SIZE ? len - off : ZRAM_CHUNK_SIZE;
+    memcpy(zram_buffer + off, zram_arena + chunk * ZRAM_CHUNK_SIZE, n);
+    off += n;
+  }
+  if (ZramDecompress(zram_buffer, len, addr) == -1) {
+    TracePrintf(1, "ZramLoad: entry %d is corrupt\n", entry);
+    return -1;
+  }
+  num_zram_loads++;
+  ZramFree(entry);
+  return 0;
+}
+
+// frees an entry without reading it
+void ZramFree(int entry) {
+  if (entry < 0 || entry >= zram_chunks || zram_entries[entry].chunk == -1) {
+    return;
+  }
+  int chunk = zram_entries[entry].chunk;
+  while (chunk != -1) {
+    zram_free_chunks[num_zram_free_chunks] = chunk;
+    num_zram_free_chunks++;
+    chunk = zram_chunk_next[chunk];
+  }
+  zram_bytes_used -= zram_entries[entry].len;
+  zram_entries[entry].chunk = -1;
+  zram_free_entries[num_zram_free_entries] = entry;
+  num_zram_free_entries++;
+}
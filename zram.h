@@ -0,0 +1,54 @@
+// Contains a compressed in-memory store for user pages evicted under memory pressure
+//
+// Andrew Chen
+// 10/2026
+
+#ifndef _zram_h
+#define _zram_h
+
+// compressed pages are kept in an arena the store allocates once at boot and never grows, since pages are
+// stored while a frame is being found for a kernel malloc, and a malloc there would re-enter the allocator
+// the arena is cut into fixed size chunks, and each page takes as many as its compressed bytes need
+#define ZRAM_CHUNK_SIZE 64
+
+// pages of arena allocated when the zram_pages boot option is not given
+#define ZRAM_DEFAULT_PAGES 8
+
+// the arena never takes more than this share of the frames free at boot, whatever zram_pages asks for
+#define ZRAM_MAX_FREE_SHARE 4
+
+// a page that does not compress to at most this many bytes is not worth keeping in the store
+#define ZRAM_MAX_COMPRESSED (PAGESIZE * 3 / 4)
+
+// one compressed page, held in a chain of arena chunks
+struct ZramEntry {
+  int chunk;                // first chunk of the compressed bytes, -1 if the entry is free
+  int len;                  // number of compressed bytes
+};
+
+typedef struct ZramEntry ZramEntry_t;
+
+// pages of arena to allocate at boot, set by the zram_pages boot option
+extern int zram_arena_pages;
+
+extern int num_zram_stores;
+extern int num_zram_rejects;
+extern int num_zram_loads;
+extern long zram_bytes_in;
+extern long zram_bytes_out;
+extern long zram_bytes_used;
+
+// allocates the arena, returns -1 if it can't, in which case nothing is ever stored
+int InitZram();
+
+// compresses the page at addr into the store and returns its entry
+// returns -1 if the page does not compress well enough or the store is full
+int ZramStore(void *addr);
+
+// decompresses an entry into the page at addr and frees the entry
+int ZramLoad(int entry, void *addr);
+
+// frees an entry without reading it
+void ZramFree(int entry);
+
+#endif